@@ -0,0 +1,104 @@
+// bot.c — greedy placement bot (see bot.h)
+// Tries every rotation x column for the current piece on a copy of the game,
+// scores the settled board and then walks the piece there one action at a time
+// and hard-drops it. With depth > 1 each settled copy gets the next piece
+// from the preview and the search goes on from there; a plan scores the
+// board at the end of it, with the lines cleared on the way.
+#include <stddef.h>
+#include "bot.h"
+
+const BotWeights BOT_DEFAULT_WEIGHTS = { -0.51, 0.76, -0.36, -0.18, 0 };
+
+void bot_init(Bot *b, const BotWeights *w) {
+    b->w = w ? *w : BOT_DEFAULT_WEIGHTS;
+    b->depth = 1;
+    b->planned_for = -1;
+    b->rot_left = 0;
+    b->target_x = 0;
+}
+
+// heights come from the engine's skyline; every cell under a column top
+// that is not filled is a hole
+double bot_evaluate(const BotWeights *w, const Game *g, int lines) {
+    int holes = 0, agg = 0, bump = 0;
+    for (int c = 0; c < g->w; ++c) agg += g->heights[c];
+    holes = agg;
+    for (int r = 0; r < g->h; ++r) holes -= __builtin_popcount(g->rows[r]);
+    for (int c = 0; c + 1 < g->w; ++c) {
+        int d = g->heights[c] - g->heights[c + 1];
+        bump += d < 0 ? -d : d;
+    }
+    double s = w->height * agg + w->lines * lines + w->holes * holes + w->bump * bump;
+    if (w->wells != 0) {                              // the walls count as full columns
+        int wells = 0;
+        for (int c = 0; c < g->w; ++c) {
+            int l = c > 0 ? g->heights[c - 1] : g->h, r = c + 1 < g->w ? g->heights[c + 1] : g->h;
+            int d = (l < r ? l : r) - g->heights[c];
+            if (d > 0) wells += d * (d + 1) / 2;
+        }
+        s += w->wells * wells;
+    }
+    return s;
+}
+
+// the settled copy d with piece shape where a new one would appear; 0 if it
+// does not fit, which is where the game would end
+static int put_next(Game *d, int shape) {
+    d->piece = shape;
+    d->mask = SHAPE_MASKS[shape];
+    d->px = d->rules == RULES_8X8 ? 2 : (d->w - 4) / 2;    // the 10x20 spawn column is random
+    d->py = 0;
+    if (!game_fits(d, d->mask, d->px, d->py)) return 0;
+    d->ghost_py = game_drop_row(d);
+    return 1;
+}
+
+// best score over the placements of g's active piece and, depth - 1 more,
+// the previewed pieces after it; *rot / *x get the first placement
+static double search(const BotWeights *w, const Game *g, int depth, int ahead, int lines, int *rot_out, int *x_out) {
+    double best = -1e300;
+    for (int rot = 0; rot < 4; ++rot) {
+        Game base = *g;
+        int ok = 1;
+        for (int i = 0; i < rot && ok; ++i) ok = game_rotate(&base, +1);
+        if (!ok) break;
+
+        for (int dir = -1; dir <= 1; dir += 2) {
+            Game t = base;
+            for (;;) {
+                Game d = t;
+                d.py = d.ghost_py;
+                int n = lines + game_settle(&d);
+                double s;
+                if (depth == 1) s = bot_evaluate(w, &d, n);
+                else if (put_next(&d, game_next(g, ahead))) s = search(w, &d, depth - 1, ahead + 1, n, NULL, NULL);
+                else s = -1e299;                                  // tops out: anything else first
+                if (s > best) {
+                    best = s;
+                    if (rot_out) { *rot_out = rot; *x_out = t.px; }
+                }
+                if (!game_move(&t, dir)) break;
+            }
+        }
+    }
+    return best;
+}
+
+static void plan(Bot *b, const Game *g) {
+    b->rot_left = 0;
+    b->target_x = g->px;
+    int depth = b->depth < 1 ? 1 : b->depth > BOT_DEPTH_MAX ? BOT_DEPTH_MAX : b->depth;
+    search(&b->w, g, depth, 0, 0, &b->rot_left, &b->target_x);
+}
+
+int bot_next_action(Bot *b, const Game *g) {
+    if (g->over || g->piece < 0) return ACT_NONE;
+    if (b->planned_for != g->pieces) {
+        plan(b, g);
+        b->planned_for = g->pieces;
+    }
+    if (b->rot_left > 0) { b->rot_left--; return ACT_ROTATE; }
+    if (g->px < b->target_x) return ACT_RIGHT;
+    if (g->px > b->target_x) return ACT_LEFT;
+    return ACT_HARD_DROP;
+}
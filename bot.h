@@ -0,0 +1,32 @@
+// bot.h — greedy placement bot for the headless engine
+#ifndef BOT_H
+#define BOT_H
+
+#include "engine.h"
+
+typedef struct {
+    double height;    // aggregate column height
+    double lines;     // lines cleared by the placement
+    double holes;     // empty cells below a filled cell
+    double bump;      // sum of |h[c] - h[c+1]|
+    double wells;     // 1 + 2 + .. + depth over the columns lower than both neighbours
+} BotWeights;
+
+#define BOT_DEPTH_MAX 3              // pieces searched: the current one and 2 previews
+
+typedef struct {
+    BotWeights w;
+    int depth;               // pieces placed per plan, 1 (greedy) .. BOT_DEPTH_MAX
+    long planned_for;        // g->pieces when the plan was made
+    int rot_left;            // rotations still to perform
+    int target_x;            // frame column after all rotations/moves
+} Bot;
+
+extern const BotWeights BOT_DEFAULT_WEIGHTS;
+
+// depth 1; set b->depth after init to look further ahead
+void bot_init(Bot *b, const BotWeights *w);
+double bot_evaluate(const BotWeights *w, const Game *g, int lines);
+int bot_next_action(Bot *b, const Game *g);
+
+#endif
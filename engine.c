@@ -0,0 +1,514 @@
+// engine.c — headless Tetris rules (see engine.h)
+// build: compiled into the batch tools, e.g.
+//        gcc -O2 -std=c11 spectate.c engine.c bot.c -o spectate -lpthread
+#include "engine.h"
+
+_Thread_local EvSource ev_here;
+_Thread_local MetSlot *met_here;
+
+static inline void emit(const Game *g, int type, int a, int b, uint32_t c) {
+    if (ev_here.ring) ev_push(ev_here.ring, ev_here.game, (uint32_t)g->time_ms, type, a, b, c);
+}
+
+static inline void count(int m, uint64_t v) {
+    if (met_here) met_add(met_here, m, v);
+}
+
+// ============================== Shapes ===========================
+// same bitmaps as SHAPES[] in tetristest.c / newtetris.c, packed 4 bits per row
+#define ROW4(a,b,c,d) ((a) | (b) << 1 | (c) << 2 | (d) << 3)
+#define MASK4(r0,r1,r2,r3) ((uint16_t)((r0) | (r1) << 4 | (r2) << 8 | (r3) << 12))
+
+const uint16_t SHAPE_MASKS[7] = {
+    MASK4(ROW4(1,1,0,0), ROW4(1,1,0,0), 0, 0),                  // O
+    MASK4(ROW4(1,0,0,0), ROW4(1,0,0,0), ROW4(1,1,0,0), 0),      // J (8x8) / L (10x20)
+    MASK4(ROW4(0,1,0,0), ROW4(0,1,0,0), ROW4(1,1,0,0), 0),      // L (8x8) / J (10x20)
+    MASK4(ROW4(0,1,1,0), ROW4(1,1,0,0), 0, 0),                  // S
+    MASK4(ROW4(1,1,0,0), ROW4(0,1,1,0), 0, 0),                  // Z
+    MASK4(ROW4(1,0,0,0), ROW4(1,0,0,0), ROW4(1,0,0,0), ROW4(1,0,0,0)), // I (vertical)
+    MASK4(ROW4(0,1,0,0), ROW4(1,1,1,0), 0, 0),                  // T (10x20 only)
+};
+
+static const char *NAMES_8X8[]   = {
+    "square", "Lleft", "Lright", "zigzagleft", "zigzagright", "straight"
+};
+static const char *NAMES_10X20[] = {
+    "square", "l-right", "l-left", "zigright", "zigleft", "straight", "tee-block"
+};
+
+int game_shape_count(Rules rules) { return rules == RULES_8X8 ? 6 : 7; }
+
+const char *game_shape_name(Rules rules, int shape) {
+    if (shape < 0 || shape >= game_shape_count(rules)) return "none";
+    return rules == RULES_8X8 ? NAMES_8X8[shape] : NAMES_10X20[shape];
+}
+
+// ============================= Masks =============================
+static unsigned mask_row(uint16_t m, int r) { return (m >> (r * 4)) & 0xF; }
+
+// rotate_right4: transpose then reverse rows -> new(r,c) = old(3-c, r)
+// rotate_left4:  transpose then reverse cols -> new(r,c) = old(c, 3-r)
+static uint16_t mask_rotate(uint16_t m, int dir) {
+    uint16_t out = 0;
+    for (int r = 0; r < 4; ++r)
+        for (int c = 0; c < 4; ++c) {
+            int sr = dir < 0 ? c : 3 - c;
+            int sc = dir < 0 ? 3 - r : r;
+            if (m & (1u << (sr * 4 + sc))) out |= (uint16_t)(1u << (r * 4 + c));
+        }
+    return out;
+}
+
+// shift the cells to the top-left corner of the frame; returns the offset
+static uint16_t mask_normalize(uint16_t m, int *dx, int *dy) {
+    *dx = *dy = 0;
+    if (!m) return m;
+    while (!(m & 0x000F)) { m >>= 4; ++*dy; }
+    while (!(m & 0x1111)) { m >>= 1; ++*dx; }
+    return m;
+}
+
+// lowest frame row holding a cell in frame column c, -1 if the column is empty
+static int mask_bottom(uint16_t m, int c) {
+    for (int r = 3; r >= 0; --r)
+        if (m & (1u << (r * 4 + c))) return r;
+    return -1;
+}
+
+// frame row bits placed at column px; -1 if a cell falls off the left wall
+static int place_bits(unsigned nib, int px) {
+    if (px >= 0) return (int)(nib << px);
+    if (nib & ((1u << -px) - 1)) return -1;
+    return (int)(nib >> -px);
+}
+
+// ========================= Placement checks ======================
+int game_fits(const Game *g, uint16_t mask, int px, int py) {
+    for (int r = 0; r < 4; ++r) {
+        unsigned nib = mask_row(mask, r);
+        if (!nib) continue;
+        int gr = py + r;
+        if (gr < 0 || gr >= g->h) return 0;          // floor / ceiling
+        int bits = place_bits(nib, px);
+        if (bits < 0 || (bits & ~g->full)) return 0;  // walls
+        if (bits & g->rows[gr]) return 0;             // settled collision
+    }
+    return 1;
+}
+
+int game_in_bounds(const Game *g, uint16_t mask, int px, int py) {
+    for (int r = 0; r < 4; ++r) {
+        unsigned nib = mask_row(mask, r);
+        if (!nib) continue;
+        if (py + r < 0 || py + r >= g->h || px < -3 || px >= g->w) return 0;  // off the board before any shift
+        int bits = place_bits(nib, px);
+        if (bits < 0 || (bits & ~g->full)) return 0;
+    }
+    return 1;
+}
+
+int game_is_rotation(Rules rules, int shape, uint16_t mask) {
+    if (shape < 0 || shape >= game_shape_count(rules)) return 0;
+    uint16_t m = SHAPE_MASKS[shape];
+    for (int k = 0; k < 4; ++k, m = mask_rotate(m, 1)) {
+        int dx, dy;                                   // 8x8 re-anchors after turning, 10x20 turns in the frame
+        if ((rules == RULES_8X8 ? mask_normalize(m, &dx, &dy) : m) == mask) return 1;
+    }
+    return 0;
+}
+
+int game_can_fall(const Game *g) {
+    return g->piece >= 0 && game_fits(g, g->mask, g->px, g->py + 1);
+}
+
+// ============================ Skyline ============================
+int game_drop_row(const Game *g) {
+    if (g->piece < 0) return -1;
+    int land = g->h;
+    for (int fc = 0; fc < 4; ++fc) {
+        int b = mask_bottom(g->mask, fc);
+        if (b < 0) continue;
+        int col = g->px + fc, r = g->py + b + 1;
+        int top = g->h - g->heights[col];        // first settled row of the column
+        if (r <= top) r = top;                   // above the skyline: land on it
+        else while (r < g->h && !(g->rows[r] & (1u << col))) ++r; // under an overhang
+        if (r - 1 - b < land) land = r - 1 - b;
+    }
+    return land;
+}
+
+// after merging cells and clearing `cleared` lines: every cleared row was
+// full, so it lay under each column's top; drop the tops by that much and
+// walk down past any holes that became the top
+static void update_heights(Game *g, int cleared) {
+    for (int c = 0; c < g->w; ++c) {
+        int hc = g->heights[c] - cleared;
+        while (hc > 0 && !(g->rows[g->h - hc] & (1u << c))) --hc;
+        g->heights[c] = (uint8_t)hc;
+    }
+}
+
+// ======================= Movement & Rotation =====================
+int game_move(Game *g, int dx) {
+    if (g->piece < 0 || !dx || !game_fits(g, g->mask, g->px + dx, g->py)) return 0;
+    g->px += dx;
+    g->ghost_py = game_drop_row(g);
+    return 1;
+}
+
+int game_rotate(Game *g, int dir) {
+    if (g->piece < 0) return 0;
+    uint16_t rot = mask_rotate(g->mask, dir);
+
+    if (g->rules == RULES_8X8) {
+        // tetristest.c: rotate inside the bounding box, no kicks, re-anchor
+        if (!game_fits(g, rot, g->px, g->py)) return 0;
+        int dx, dy;
+        g->mask = mask_normalize(rot, &dx, &dy);
+        g->px += dx; g->py += dy;
+        g->ghost_py = game_drop_row(g);
+        return 1;
+    }
+
+    // newtetris.c: rotate inside the 4x4 frame with tiny wall kicks
+    static const int kicks[][2] = { {0,0}, {+1,0}, {-1,0}, {0,-1} };
+    for (int i = 0; i < 4; ++i) {
+        int nfx = g->px + kicks[i][0], nfy = g->py + kicks[i][1];
+        if (game_fits(g, rot, nfx, nfy)) {
+            g->mask = rot; g->px = nfx; g->py = nfy;
+            g->ghost_py = game_drop_row(g);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int game_soft_drop(Game *g) {
+    if (!g->soft_drop_enabled || !game_can_fall(g)) return 0;
+    g->py += 1;
+    return 1;
+}
+
+// =============== Line clear + collapse + scoring/level ===========
+// gravity and lock delay of the current level (speed.h)
+static void load_speed(Game *g) {
+    const SpeedLevel *s = speed_level(g->speed_curve, g->level);
+    if (!g->gravity_fixed) {
+        g->fall_rows = s->rows;
+        g->fall_interval_ms = s->per_ms;
+    }
+    g->lock_delay_ms = s->lock_ms;
+}
+
+static int clear_full_lines_and_collapse(Game *g) {
+    int cleared = 0, dst = g->h - 1;
+    for (int r = g->h - 1; r >= 0; --r) {
+        if (g->rows[r] == g->full) { ++cleared; continue; }
+        g->rows[dst--] = g->rows[r];
+    }
+    while (dst >= 0) g->rows[dst--] = 0;
+    return cleared;
+}
+
+int game_settle(Game *g) {
+    if (g->piece < 0) return 0;
+    for (int r = 0; r < 4; ++r) {
+        unsigned nib = mask_row(g->mask, r);
+        int gr = g->py + r;
+        if (!nib || gr < 0 || gr >= g->h) continue;
+        unsigned bits = (unsigned)place_bits(nib, g->px);
+        g->rows[gr] |= (uint16_t)bits;
+        for (int c = 0; bits; ++c, bits >>= 1)
+            if ((bits & 1) && g->heights[c] < g->h - gr) g->heights[c] = (uint8_t)(g->h - gr);
+    }
+    g->piece = -1;
+    int cleared = clear_full_lines_and_collapse(g);
+    if (cleared) update_heights(g, cleared);
+    return cleared;
+}
+
+// ============================== Versus ===========================
+// lines sent for 0..4 lines cleared
+static const uint8_t ATTACK[5] = { 0, 0, 1, 2, 4 };
+
+void game_receive_garbage(Game *g, int lines) {
+    if (lines <= 0 || g->over) return;
+    if (lines > g->h) lines = g->h;               // any more is just as fatal
+    int i;
+    if (g->garbage_count == EN_GARBAGE_Q) {       // full: extend the newest batch
+        i = (g->garbage_head + g->garbage_count - 1) % EN_GARBAGE_Q;
+        if (g->garbage_lines[i] + lines > 255) lines = 255 - g->garbage_lines[i];
+    } else {
+        i = (g->garbage_head + g->garbage_count++) % EN_GARBAGE_Q;
+        g->garbage_lines[i] = 0;
+        g->garbage_hole[i] = (uint8_t)rng_below(&g->garbage_rng, (uint32_t)g->w);
+    }
+    g->garbage_lines[i] = (uint8_t)(g->garbage_lines[i] + lines);
+    g->garbage_pending += lines;
+}
+
+int game_take_attack(Game *g) {
+    int n = g->attack_out;
+    g->attack_out = 0;
+    return n;
+}
+
+// the attack of a clear first cancels queued garbage, oldest first
+static void send_attack(Game *g, int lines_cleared) {
+    int attack = ATTACK[lines_cleared > 4 ? 4 : lines_cleared];
+    while (attack && g->garbage_count) {
+        uint8_t *front = &g->garbage_lines[g->garbage_head];
+        int n = attack < *front ? attack : *front;
+        *front = (uint8_t)(*front - n);
+        attack -= n;
+        g->garbage_pending -= n;
+        if (!*front) {
+            g->garbage_head = (uint8_t)((g->garbage_head + 1) % EN_GARBAGE_Q);
+            g->garbage_count--;
+        }
+    }
+    g->attack_out += attack;
+}
+
+// push the queued garbage in under the stack: one row shift per batch,
+// like a line clear in reverse. Cells pushed out of the top end the game.
+static void insert_garbage(Game *g) {
+    while (g->garbage_count) {
+        int n = g->garbage_lines[g->garbage_head], hole = g->garbage_hole[g->garbage_head];
+        g->garbage_head = (uint8_t)((g->garbage_head + 1) % EN_GARBAGE_Q);
+        g->garbage_count--;
+        g->garbage_pending -= n;
+        if (n > g->h) n = g->h;
+        for (int r = 0; r < n; ++r)
+            if (g->rows[r]) g->over = 1;
+        for (int r = 0; r + n < g->h; ++r) g->rows[r] = g->rows[r + n];
+        uint16_t row = (uint16_t)(g->full & ~(1u << hole));
+        for (int r = g->h - n; r < g->h; ++r) g->rows[r] = row;
+        for (int c = 0; c < g->w; ++c) {
+            int hc = g->heights[c] + n;               // the old top moves up
+            if (c == hole && !g->heights[c]) hc = 0;  // nothing over the hole yet
+            g->heights[c] = (uint8_t)(hc > g->h ? g->h : hc);
+        }
+        if (g->over) return;
+    }
+}
+
+static void apply_scoring_and_level(Game *g, int lines_cleared) {
+    if (lines_cleared == 1) g->score += 100;
+    else if (lines_cleared == 2) g->score += 300;
+    else if (lines_cleared == 3) g->score += 500;
+    else if (lines_cleared >= 4) g->score += 800;
+
+    if (lines_cleared) {
+        emit(g, EV_LINES, lines_cleared, 0, (uint32_t)g->score);
+        count(MET_LINES, (uint64_t)lines_cleared);
+    }
+    g->lines_total += lines_cleared;
+    while (g->lines_total >= g->next_level_lines) {
+        g->level++;
+        emit(g, EV_LEVEL, g->level, 0, 0);
+        count(MET_LEVEL_UPS, 1);
+        g->next_level_lines = speed_next_level_lines(g->speed_curve, g->start_level, g->level);
+        load_speed(g);
+    }
+}
+
+// ============================== Spawn ============================
+static void spawn_block(Game *g) {
+    int spawn_x = 2;                                  // tetristest.c: fixed column
+    if (g->rules == RULES_10X20) spawn_x = (int)rng_below(&g->rng, (uint32_t)(g->w - 3));
+
+    int shape = pieces_next(&g->queue);
+
+    if (!game_fits(g, SHAPE_MASKS[shape], spawn_x, 0)) { // blocked by settled cells
+        g->over = 1;
+        g->piece = -1;
+        emit(g, EV_OVER, 0, 0, (uint32_t)g->score);
+        count(MET_TOPOUTS, 1);
+        return;
+    }
+    g->piece = shape;
+    g->mask = SHAPE_MASKS[shape];
+    g->px = spawn_x;
+    g->py = 0;
+    g->ghost_py = game_drop_row(g);
+    g->pieces++;
+    emit(g, EV_SPAWN, shape, spawn_x, 0);
+    count(MET_PIECES, 1);
+}
+
+static void lock_piece(Game *g) {
+    emit(g, EV_LOCK, g->piece, (g->px & 0xFF) | (g->py & 0xFF) << 8, (uint32_t)g->pieces);
+    int lines = game_settle(g);
+    apply_scoring_and_level(g, lines);
+    if (g->versus) {
+        if (lines) send_attack(g, lines);
+        else insert_garbage(g);
+        if (g->over) {
+            g->piece = -1;
+            emit(g, EV_OVER, 0, 0, (uint32_t)g->score);
+            count(MET_TOPOUTS, 1);
+            return;
+        }
+    }
+    g->lock_timer_ms = 0;
+    g->fall_acc = 0;
+    spawn_block(g);
+}
+
+int game_hard_drop(Game *g) {
+    if (g->piece < 0 || g->over) return 0;
+    int rows = g->ghost_py - g->py;
+    g->py = g->ghost_py;
+    lock_piece(g);
+    return rows;
+}
+
+// ========================= Gravity (time-based) ==================
+// A tick works out how many rows came due, moves the piece at most down to
+// its landing row (ghost_py, one skyline query) and counts the time spent
+// resting on the stack towards the lock delay. The cost is the same at 20G
+// as at one row per second, and a long stall is one step, not a loop.
+void game_tick(Game *g, int dt_ms) {
+    if (g->over) return;
+    g->time_ms += dt_ms;
+    if (g->piece < 0) { spawn_block(g); return; }
+
+    long acc = g->fall_acc + (long)dt_ms * g->fall_rows;
+    long due = acc / g->fall_interval_ms;
+    int room = g->ghost_py - g->py;
+    long rest_ms = dt_ms;
+
+    if (due < room) {
+        g->fall_acc = acc % g->fall_interval_ms;
+        if (due) { g->py += (int)due; g->lock_timer_ms = 0; } // still airborne afterwards
+        return;
+    }
+    if (room > 0) {
+        // the landing row came due once fall_acc + t * fall_rows reached room * interval
+        long t = ((long)room * g->fall_interval_ms - g->fall_acc + g->fall_rows - 1) / g->fall_rows;
+        rest_ms = dt_ms - t;
+        g->py += room;
+        g->lock_timer_ms = 0;
+    }
+    g->fall_acc = acc % g->fall_interval_ms;  // rows owed while resting are dropped
+    g->lock_timer_ms += rest_ms;
+    if (g->lock_timer_ms >= g->lock_delay_ms) lock_piece(g);
+}
+
+long game_due_ms(const Game *g) {
+    if (g->over) return -1;
+    if (g->piece < 0) return 0;
+    if (g->ghost_py > g->py)   // the next row comes due once fall_acc reaches the interval
+        return (g->fall_interval_ms - g->fall_acc + g->fall_rows - 1) / g->fall_rows;
+    long left = g->lock_delay_ms - g->lock_timer_ms;
+    return left > 0 ? left : 0;
+}
+
+void game_set_gravity(Game *g, int rows, int per_ms) {
+    g->gravity_fixed = rows > 0 && per_ms > 0;
+    if (g->gravity_fixed) {
+        g->fall_rows = rows;
+        g->fall_interval_ms = per_ms;
+    }
+    load_speed(g);
+    g->fall_acc = 0;
+}
+
+void game_apply(Game *g, int action) {
+    if (g->over) return;
+    int px = g->px, py = g->py;
+    switch (action) {
+        case ACT_LEFT:
+        case ACT_RIGHT:
+            if (game_move(g, action == ACT_LEFT ? -1 : +1)) emit(g, EV_MOVE, g->px - px, g->px, 0);
+            break;
+        case ACT_ROTATE:
+            if (!game_rotate(g, +1)) break;
+            emit(g, EV_ROTATE, +1, 0, 0);
+            if (g->rules == RULES_10X20 && (g->px != px || g->py != py))   // which of the kicks
+                emit(g, EV_KICK, g->px > px ? 1 : g->px < px ? 2 : 3, 0, 0);
+            break;
+        case ACT_SOFT_DROP: game_soft_drop(g);    break;
+        case ACT_HARD_DROP: game_hard_drop(g);    break;
+        default: break;
+    }
+}
+
+// ============================== Setup ============================
+void game_reset(Game *g, Rng rng) {
+    for (int r = 0; r < EN_MAX_H; ++r) g->rows[r] = 0;
+    for (int c = 0; c < EN_MAX_W; ++c) g->heights[c] = 0;
+    pieces_init(&g->queue, rng_split(&rng, 0), game_shape_count(g->rules), g->piece_policy);
+    g->rng = rng_split(&rng, 1);
+    g->garbage_rng = rng_split(&rng, 2);
+    g->attack_out = 0;
+    g->garbage_head = g->garbage_count = 0;
+    g->garbage_pending = 0;
+    g->score = 0;
+    g->lines_total = 0;
+    g->level = g->start_level;
+    g->next_level_lines = speed_next_level_lines(g->speed_curve, g->start_level, g->level);
+    load_speed(g);
+    g->fall_acc = 0;
+    g->lock_timer_ms = 0;
+    g->over = 0;
+    g->pieces = 0;
+    g->time_ms = 0;
+    g->piece = -1;
+    spawn_block(g);
+}
+
+void game_init(Game *g, Rules rules, Rng rng, int start_level) {
+    g->rules = rules;
+    g->w = rules == RULES_8X8 ? 8 : 10;
+    g->h = rules == RULES_8X8 ? 8 : 20;
+    g->full = (uint16_t)((1u << g->w) - 1);
+    g->start_level = start_level;
+    g->speed_curve = rules == RULES_8X8 ? SPEED_8X8 : SPEED_10X20;
+    g->soft_drop_enabled = 1;
+    g->piece_policy = PIECES_UNIFORM;
+    g->gravity_fixed = 0;
+    g->versus = 0;
+    game_reset(g, rng);
+}
+
+// FNV-1a over the fields one at a time
+static uint64_t mix(uint64_t h, uint64_t v) { return (h ^ v) * 0x100000001B3ull; }
+
+uint64_t game_checksum(const Game *g) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (int r = 0; r < g->h; ++r) h = mix(h, g->rows[r]);
+    h = mix(h, (uint64_t)(g->piece + 1) << 16 | g->mask);
+    h = mix(h, (uint64_t)(uint32_t)g->px << 32 | (uint32_t)g->py);
+    for (int i = 0; i < g->queue.count; ++i) h = mix(h, (uint64_t)pieces_peek(&g->queue, i));
+    h = mix(h, g->queue.rng.index);
+    h = mix(h, g->rng.index);
+    h = mix(h, (uint64_t)(uint32_t)g->score << 32 | (uint32_t)g->lines_total);
+    h = mix(h, (uint64_t)(uint32_t)g->level << 32 | (uint32_t)g->over);
+    h = mix(h, (uint64_t)g->fall_acc);
+    h = mix(h, (uint64_t)g->lock_timer_ms);
+    h = mix(h, (uint64_t)g->time_ms);
+    h = mix(h, g->garbage_rng.index);
+    h = mix(h, (uint64_t)(uint32_t)g->attack_out << 32 | (uint32_t)g->garbage_pending);
+    for (int i = 0; i < g->garbage_count; ++i) {
+        int k = (g->garbage_head + i) % EN_GARBAGE_Q;
+        h = mix(h, (uint64_t)g->garbage_lines[k] << 8 | g->garbage_hole[k]);
+    }
+    return h;
+}
+
+int game_next(const Game *g, int i) { return pieces_peek(&g->queue, i); }
+
+int game_cell(const Game *g, int r, int c) {
+    if (g->rows[r] & (1u << c)) return 2;
+    if (g->piece >= 0) {
+        int fr = r - g->py, fc = c - g->px;
+        if (fr >= 0 && fr < 4 && fc >= 0 && fc < 4 && (g->mask & (1u << (fr * 4 + fc))))
+            return 1;
+        int gr = r - g->ghost_py;
+        if (gr >= 0 && gr < 4 && fc >= 0 && fc < 4 && (g->mask & (1u << (gr * 4 + fc))))
+            return 3;
+    }
+    return 0;
+}
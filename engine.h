@@ -0,0 +1,149 @@
+// engine.h — headless Tetris rules shared by the batch tools
+// Mirrors the two interactive games: the 8x8 board of tetristest.c and the
+// 10x20 board of newtetris.c. All state lives in one Game struct so many
+// games can run side by side (one per thread, thousands per process).
+// Game holds no pointers and the rules use integers only, so a plain struct
+// copy is a complete snapshot, and replaying the same actions and ticks from
+// it gives the same game on any host (rollback.c relies on both).
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdint.h>
+#include "rng.h"
+#include "speed.h"
+#include "events.h"
+#include "metrics.h"
+
+#define EN_MAX_W 10
+#define EN_MAX_H 20
+#define EN_GARBAGE_Q 8             // garbage batches a game can have queued
+
+typedef enum { RULES_8X8, RULES_10X20 } Rules;
+
+// actions a player or bot can feed into game_apply()
+enum {
+    ACT_NONE,
+    ACT_LEFT,
+    ACT_RIGHT,
+    ACT_ROTATE,
+    ACT_SOFT_DROP,
+    ACT_HARD_DROP,
+    ACT_COUNT
+};
+
+typedef struct {
+    Rules rules;
+    int w, h;
+    uint16_t full;                 // (1 << w) - 1
+    uint16_t rows[EN_MAX_H];       // settled cells, bit c = column c
+    uint8_t heights[EN_MAX_W];     // skyline: rows from the floor to the top settled cell
+
+    int piece;                     // shape index, -1 = none
+    uint16_t mask;                 // active piece in its 4x4 frame, bit r*4+c
+    int px, py;                    // top-left of the 4x4 frame on the board
+    int ghost_py;                  // py the piece would land at (game_drop_row)
+
+    PiecePolicy piece_policy;      // uniform (default) or bag, read by game_reset()
+    PieceQueue queue;              // upcoming pieces, see game_next()
+    Rng rng;                       // spawn columns (10x20)
+    Rng garbage_rng;               // hole columns of incoming garbage
+
+    int score, level, lines_total, start_level;
+    int speed_curve;               // SpeedCurve, read by game_reset()
+    int next_level_lines;          // lines_total at which level goes up
+    // gravity: fall_rows rows per fall_interval_ms, from the speed curve
+    // unless game_set_gravity() pinned a rate
+    int fall_rows, fall_interval_ms, gravity_fixed;
+    int lock_delay_ms;
+    long fall_acc;                 // ms * fall_rows not yet due as a row
+    long lock_timer_ms;            // time spent resting on the stack
+    int soft_drop_enabled;
+    int over;
+
+    // versus: clears attack the opponent (game_take_attack), and received
+    // garbage waits in a queue until a piece locks without clearing a line
+    int versus;
+    int attack_out;                // lines sent, not yet taken by the match
+    uint8_t garbage_lines[EN_GARBAGE_Q], garbage_hole[EN_GARBAGE_Q];
+    uint8_t garbage_head, garbage_count;
+    int garbage_pending;           // sum of garbage_lines[]
+
+    long pieces;                   // pieces spawned so far
+    long time_ms;                  // game time fed through game_tick()
+} Game;
+
+extern const uint16_t SHAPE_MASKS[7];
+
+// Games emit their events (events.h) into the ring of the thread that runs
+// them, tagged with ev_here.game; a thread without a ring emits nothing.
+// Only the paths a player takes emit: game_apply() moves and rotations,
+// spawns, locks, clears, level ups and the end, not the lookahead calls.
+typedef struct {
+    EvRing *ring;
+    uint32_t game;
+} EvSource;
+
+extern _Thread_local EvSource ev_here;
+
+// The same paths count pieces, lines, level ups and top-outs into the
+// thread's metrics slot (metrics.h), if it has one; ending games and
+// timing frames is up to whoever runs them.
+extern _Thread_local MetSlot *met_here;
+
+int game_shape_count(Rules rules);
+const char *game_shape_name(Rules rules, int shape);
+
+// rng is the game's own stream (rng_init / rng_split), so a game replays
+// identically from the same stream whichever thread or process runs it
+void game_init(Game *g, Rules rules, Rng rng, int start_level);
+void game_reset(Game *g, Rng rng);
+
+// i-th upcoming piece, 0 = next (i < PIECE_PREVIEW_MAX)
+int game_next(const Game *g, int i);
+
+int game_fits(const Game *g, uint16_t mask, int px, int py);
+// game_fits() without the settled cells: only the walls, floor and ceiling
+int game_in_bounds(const Game *g, uint16_t mask, int px, int py);
+// mask is one of shape's rotations as the rules hold it in Game.mask
+int game_is_rotation(Rules rules, int shape, uint16_t mask);
+int game_move(Game *g, int dx);
+int game_rotate(Game *g, int dir);
+int game_can_fall(const Game *g);
+int game_soft_drop(Game *g);
+int game_hard_drop(Game *g);       // returns the rows dropped; locks the piece
+
+// py at which the active piece lands, from the skyline and the piece's
+// bottom profile: O(piece width) unless the piece is tucked under an overhang
+int game_drop_row(const Game *g);
+void game_apply(Game *g, int action);
+void game_tick(Game *g, int dt_ms);
+
+// ms of game time until game_tick() would next change the state (the next
+// row falls or the piece locks); 0 if that is due now, -1 once the game is
+// over. Lets event loops sleep between gravity steps instead of polling.
+long game_due_ms(const Game *g);
+
+// versus: queue lines of garbage (one hole column per batch); incoming
+// garbage is cancelled by the game's own attacks before it is sent on
+void game_receive_garbage(Game *g, int lines);
+// attack lines produced since the last call
+int game_take_attack(Game *g);
+
+// gravity of rows rows per per_ms ms from now on, e.g. (20, 16) is 20G at
+// 60 Hz and (1, 3000) a third of level 0; rows <= 0 returns to the speed curve
+void game_set_gravity(Game *g, int rows, int per_ms);
+
+// write the active piece into rows[] and collapse full lines, keeping
+// heights[] current; no spawn, no scoring. Returns the number of lines
+// cleared. Used by lookahead.
+int game_settle(Game *g);
+
+// hash of everything that decides how the game continues (not padding),
+// for comparing two copies of a game, e.g. across the network
+uint64_t game_checksum(const Game *g);
+
+// 0 empty, 1 active, 2 settled (same encoding as newtetris.c's board),
+// 3 ghost (where the active piece would land)
+int game_cell(const Game *g, int r, int c);
+
+#endif
@@ -0,0 +1,203 @@
+// eventbench.c — cost and integrity of the gameplay event log (events.h)
+// build: gcc -O2 -std=c11 -pthread eventbench.c events.c engine.c bot.c -o eventbench
+// run:   ./eventbench -t 4 -g 2000 -r 7 -o game.events
+//
+// Each thread plays its share of bot games in rounds, every game twice in
+// a row, once with no ring and once emitting into its own ring. The
+// threads' CPU time of the two gives one cost per event for each round,
+// and the median and spread over the rounds are reported. A tight emit loop gives the cost of one push on its
+// own. The log
+// is then read back: every event the rings took must be in it, and every
+// event they dropped must be accounted for by an EV_DROPPED record.
+// -f sets how often the log thread wakes; a long interval makes the rings
+// fill up and shows the dropping.
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include "engine.h"
+#include "bot.h"
+#include "events.h"
+
+// ============================= TIMING ============================
+static long now_ns(void) {
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)(ts.tv_sec*1000000000LL + ts.tv_nsec);
+}
+
+// time this thread ran, so the log thread and the scheduler stay out of it
+static long thread_cpu_ns(void) {
+    struct timespec ts; clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (long)(ts.tv_sec*1000000000LL + ts.tv_nsec);
+}
+
+// ============================= OPTIONS ===========================
+static int opt_threads = 2;
+static long opt_games = 1000;
+static int opt_rounds = 5;           // times every game is played each way
+static int opt_flush_ms = 2;
+static int opt_bot_ms = 50;
+static const char *opt_log = "game.events";
+static uint64_t opt_seed = 1;
+
+// ============================= PLAYERS ===========================
+typedef struct {
+    int id;
+    pthread_t tid;
+    long first, last;                // games [first, last)
+    long off_ns, on_ns, emitted;     // thread CPU time without and with the ring
+} Player;
+
+// one bot game from its seed; returns the thread CPU time it took
+static long play_game(long id) {
+    long t0 = thread_cpu_ns();
+    Rng r;
+    rng_init(&r, opt_seed, (uint64_t)id);
+    Game g;
+    game_init(&g, id % 4 == 3 ? RULES_8X8 : RULES_10X20, r, 0);
+    Bot b;
+    bot_init(&b, &BOT_DEFAULT_WEIGHTS);
+    ev_here.game = (uint32_t)id;
+    while (!g.over && g.time_ms < 600000) {
+        game_apply(&g, bot_next_action(&b, &g));
+        game_tick(&g, opt_bot_ms);
+    }
+    return thread_cpu_ns() - t0;
+}
+
+// every game twice in a row, without and with the ring, the order
+// alternating, so what slows the machine down weighs on both alike
+static void *play_main(void *arg) {
+    Player *p = arg;
+    EvRing *ring = ev_attach();
+    for (long id = p->first; id < p->last; ++id)
+        for (int k = 0; k < 2; ++k) {
+            int on = k ^ (int)(id & 1);
+            ev_here.ring = on ? ring : NULL;
+            *(on ? &p->on_ns : &p->off_ns) += play_game(id);
+        }
+    ev_here.ring = NULL;
+    if (ring) p->emitted = atomic_load(&ring->head) + atomic_load(&ring->dropped);
+    return NULL;
+}
+
+// one round of all the games on all players: the extra CPU time per event
+// emitted; *emitted, *off_ns and *on_ns get the round's totals
+static double run(long *emitted, long *off_ns, long *on_ns) {
+    Player *ps = calloc((size_t)opt_threads, sizeof *ps);
+    if (!ps) { perror("calloc"); exit(1); }
+    for (int i = 0; i < opt_threads; ++i) {
+        ps[i].id = i;
+        ps[i].first = opt_games * i / opt_threads;
+        ps[i].last = opt_games * (i + 1) / opt_threads;
+        pthread_create(&ps[i].tid, NULL, play_main, &ps[i]);
+    }
+    *emitted = *off_ns = *on_ns = 0;
+    for (int i = 0; i < opt_threads; ++i) {
+        pthread_join(ps[i].tid, NULL);
+        *emitted += ps[i].emitted;
+        *off_ns += ps[i].off_ns;
+        *on_ns += ps[i].on_ns;
+    }
+    free(ps);
+    return *emitted ? (double)(*on_ns - *off_ns) / *emitted : 0.0;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// ============================= READING ===========================
+// check the log against the writer's counts; 0 if anything is off
+static int check_log(const char *path, const EvLogStats *st) {
+    FILE *f = fopen(path, "rb");
+    if (!f) { perror(path); return 0; }
+    struct { uint32_t magic; uint16_t version, size; uint8_t pad[8]; } h;
+    if (fread(&h, sizeof h, 1, f) != 1 || h.magic != EV_MAGIC || h.version != EV_VERSION ||
+        h.size != sizeof(Event)) {
+        fprintf(stderr, "%s: not an event log\n", path);
+        fclose(f);
+        return 0;
+    }
+    static const char *names[] = { "?", "spawn", "move", "rotate", "kick", "lock", "lines", "level", "over", "dropped" };
+    long count[EV_DROPPED + 1] = { 0 }, events = 0, dropped = 0, bad = 0;
+    Event e;
+    while (fread(&e, sizeof e, 1, f) == 1) {
+        if (e.type < EV_SPAWN || e.type > EV_DROPPED) { bad++; continue; }
+        count[e.type]++;
+        if (e.type == EV_DROPPED) dropped += e.c;
+        else events++;
+    }
+    fclose(f);
+    printf("log:");
+    for (int t = EV_SPAWN; t <= EV_DROPPED; ++t) printf(" %s %ld", names[t], count[t]);
+    printf("\n");
+    int ok = !bad && events == st->events && dropped == st->dropped;
+    printf("log check: %ld events (writer %ld), %ld dropped (writer %ld), %ld unknown: %s\n",
+           events, st->events, dropped, st->dropped, bad, ok ? "ok" : "MISMATCH");
+    return ok;
+}
+
+// ================================ MAIN ===========================
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-t threads] [-g games] [-r rounds] [-f flush_ms] [-b bot_ms] [-o log] [-s seed]\n", argv0);
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "t:g:r:f:b:o:s:")) != -1) {
+        switch (opt) {
+            case 't': opt_threads = atoi(optarg); break;
+            case 'g': opt_games = atol(optarg); break;
+            case 'r': opt_rounds = atoi(optarg); break;
+            case 'f': opt_flush_ms = atoi(optarg); break;
+            case 'b': opt_bot_ms = atoi(optarg); break;
+            case 'o': opt_log = optarg; break;
+            case 's': opt_seed = strtoull(optarg, NULL, 10); break;
+            default: usage(argv[0]);
+        }
+    }
+    if (opt_threads < 1 || opt_games < 1 || opt_rounds < 1 || opt_flush_ms < 1 || opt_bot_ms < 1) usage(argv[0]);
+
+    if (ev_log_start(opt_log, opt_flush_ms) < 0) { fprintf(stderr, "%s: %s\n", opt_log, strerror(errno)); return 1; }
+
+    // one push on its own: a private ring, emptied between rounds as if
+    // the log thread kept up
+    static EvRing solo;
+    long n = 0, t0 = now_ns(), t1;
+    do {
+        for (int i = 0; i < EV_RING; ++i) ev_push(&solo, 0, (uint32_t)n, EV_MOVE, 1, i, 0);
+        atomic_store(&solo.tail, atomic_load(&solo.head));
+        n += EV_RING;
+        t1 = now_ns();
+    } while (t1 - t0 < 200000000L);
+    printf("push: %.2f ns per event (%ld events, %u dropped)\n",
+           (double)(t1 - t0) / n, n, atomic_load(&solo.dropped));
+
+    double *cost = calloc((size_t)opt_rounds, sizeof *cost);
+    if (!cost) { perror("calloc"); return 1; }
+    long off_cpu = 0, on_cpu = 0, on_n = 0;
+    for (int k = 0; k < opt_rounds; ++k) {
+        long n, off, on;
+        cost[k] = run(&n, &off, &on);
+        off_cpu += off; on_cpu += on; on_n += n;
+    }
+    EvLogStats st;
+    ev_log_stop(&st);
+    qsort(cost, (size_t)opt_rounds, sizeof *cost, cmp_double);
+    printf("%ld games on %d threads, %d rounds: %.3f s CPU without events, %.3f s with %.0f events (%.1f per game)\n",
+           opt_games, opt_threads, opt_rounds, off_cpu / 1e9 / opt_rounds, on_cpu / 1e9 / opt_rounds,
+           (double)on_n / opt_rounds, (double)on_n / opt_rounds / opt_games);
+    printf("  %+.1f ns per event emitted in play (median; rounds %+.1f .. %+.1f)\n",
+           cost[opt_rounds / 2], cost[0], cost[opt_rounds - 1]);
+    free(cost);
+    printf("writer: %ld events, %ld dropped, %.1f MB in %ld writes\n",
+           st.events, st.dropped, st.bytes / 1e6, st.batches);
+    return check_log(opt_log, &st) ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+// events.c — the log thread behind events.h
+// build: linked into the tools that record events, e.g.
+//        gcc -O2 -std=c11 -pthread eventbench.c events.c engine.c bot.c -o eventbench
+#define _DEFAULT_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "events.h"
+
+#define BATCH 4096                   // events per write()
+
+static struct {
+    int fd, flush_ms;
+    pthread_t tid;
+    pthread_mutex_t lock;            // attaching only
+    _Atomic(EvRing *) rings;
+    atomic_int stop;
+    uint32_t next_id;
+    EvLogStats st;
+    Event buf[BATCH];
+    int n;
+} lg = { .fd = -1, .lock = PTHREAD_MUTEX_INITIALIZER };
+
+// ============================= Writing ===========================
+static void flush(void) {
+    const uint8_t *p = (const uint8_t *)lg.buf;
+    size_t len = (size_t)lg.n * sizeof *lg.buf;
+    for (size_t done = 0; done < len; ) {
+        ssize_t k = write(lg.fd, p + done, len - done);
+        if (k < 0 && errno == EINTR) continue;
+        if (k < 0) break;                                // disk trouble: lose the batch, not the game
+        done += (size_t)k;
+    }
+    if (len) { lg.st.bytes += (long)len; lg.st.batches++; }
+    lg.n = 0;
+}
+
+static void put(const Event *e) {
+    lg.buf[lg.n++] = *e;
+    if (lg.n == BATCH) flush();
+}
+
+// copy out what one ring has; returns the events taken
+static long drain(EvRing *r) {
+    unsigned t = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    unsigned h = atomic_load_explicit(&r->head, memory_order_acquire);
+    for (unsigned i = t; i != h; ++i) put(&r->ev[i & (EV_RING - 1)]);
+    atomic_store_explicit(&r->tail, h, memory_order_release);
+
+    unsigned d = atomic_load_explicit(&r->dropped, memory_order_relaxed);
+    if (d != r->dropped_logged) {
+        Event e = { .game = r->id, .type = EV_DROPPED, .c = d - r->dropped_logged };
+        put(&e);
+        lg.st.dropped += d - r->dropped_logged;
+        r->dropped_logged = d;
+    }
+    return (long)(h - t);
+}
+
+static void *log_main(void *arg) {
+    (void)arg;
+    for (;;) {
+        int last = atomic_load(&lg.stop);                // a final pass after stop is seen
+        for (EvRing *r = atomic_load_explicit(&lg.rings, memory_order_acquire); r; r = r->next)
+            lg.st.events += drain(r);
+        flush();
+        if (last) return NULL;
+        struct timespec ts = { .tv_sec = lg.flush_ms / 1000, .tv_nsec = (lg.flush_ms % 1000) * 1000000L };
+        nanosleep(&ts, NULL);
+    }
+}
+
+// ============================== API ==============================
+int ev_log_start(const char *path, int flush_ms) {
+    lg.fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (lg.fd < 0) return -1;
+    struct { uint32_t magic; uint16_t version, size; uint8_t pad[8]; } h = { EV_MAGIC, EV_VERSION, sizeof(Event), { 0 } };
+    if (write(lg.fd, &h, sizeof h) != (ssize_t)sizeof h) { int e = errno; close(lg.fd); lg.fd = -1; errno = e; return -1; }
+    lg.flush_ms = flush_ms > 0 ? flush_ms : 1;
+    memset(&lg.st, 0, sizeof lg.st);
+    lg.st.bytes = sizeof h;
+    atomic_store(&lg.stop, 0);
+    int err = pthread_create(&lg.tid, NULL, log_main, NULL);
+    if (err) { close(lg.fd); lg.fd = -1; errno = err; return -1; }
+    return 0;
+}
+
+EvRing *ev_attach(void) {
+    if (lg.fd < 0) return NULL;
+    EvRing *r = aligned_alloc(64, sizeof *r);
+    if (!r) return NULL;
+    memset(r, 0, sizeof *r);
+    pthread_mutex_lock(&lg.lock);
+    r->id = lg.next_id++;
+    r->next = atomic_load_explicit(&lg.rings, memory_order_relaxed);
+    atomic_store_explicit(&lg.rings, r, memory_order_release);
+    pthread_mutex_unlock(&lg.lock);
+    return r;
+}
+
+void ev_log_stop(EvLogStats *st) {
+    if (lg.fd < 0) return;
+    atomic_store(&lg.stop, 1);
+    pthread_join(lg.tid, NULL);
+    close(lg.fd);
+    lg.fd = -1;
+    for (EvRing *r = atomic_load(&lg.rings), *next; r; r = next) { next = r->next; free(r); }
+    atomic_store(&lg.rings, NULL);
+    if (st) *st = lg.st;
+}
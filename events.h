@@ -0,0 +1,87 @@
+// events.h — gameplay events through per-thread rings to a binary log
+// Game code emits fixed 16-byte events (spawn, move, rotate, kick, lock,
+// lines, level, game over) into the ring of the thread it runs on. A ring
+// has one producer and one consumer, so pushing is a few plain stores and
+// one release store of the head, with no locks and no system calls; when a
+// ring is full the event is dropped and counted, never waited for.
+//
+// One background thread (events.c) drains every ring in batches and
+// appends them to the log, with an EV_DROPPED record wherever a ring lost
+// events, so a reader of the log knows where it has gaps.
+//
+// log: a 16-byte header { magic u32, version u16, event size u16, 8 - }
+//      and then Events back to back, in host byte order
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define EV_MAGIC   0x474C5645u       // "EVLG"
+#define EV_VERSION 1
+#define EV_RING    4096              // events per ring, power of two
+
+enum {
+    EV_SPAWN = 1,    // a shape, b px
+    EV_MOVE,         // a dx, b px
+    EV_ROTATE,       // a dir
+    EV_KICK,         // a kick used by the last rotation (1..3; 0 = in place, not sent)
+    EV_LOCK,         // a shape, b px | py << 8, c pieces
+    EV_LINES,        // a lines, c score
+    EV_LEVEL,        // a level
+    EV_OVER,         // c score
+    EV_DROPPED,      // written by the log thread: c events a ring dropped, game = ring id
+};
+
+typedef struct {
+    uint32_t game;                   // the emitter's tag for the game
+    uint32_t time_ms;                // game time
+    uint8_t type;
+    int8_t a;
+    uint16_t b;
+    uint32_t c;
+} Event;
+
+_Static_assert(sizeof(Event) == 16, "Event is the log format");
+
+typedef struct EvRing {
+    _Alignas(64) atomic_uint head;   // producer: events pushed
+    unsigned tail_seen;              // producer's last look at tail
+    atomic_uint dropped;             // producer: events lost to a full ring
+    _Alignas(64) atomic_uint tail;   // consumer: events taken
+    unsigned dropped_logged;         // consumer
+    uint32_t id;
+    struct EvRing *next;             // the log thread's list
+    Event ev[EV_RING];
+} EvRing;
+
+static inline void ev_push(EvRing *r, uint32_t game, uint32_t time_ms, int type, int a, int b, uint32_t c) {
+    unsigned h = atomic_load_explicit(&r->head, memory_order_relaxed);
+    if (h - r->tail_seen == EV_RING) {                  // looks full: has the consumer moved on?
+        r->tail_seen = atomic_load_explicit(&r->tail, memory_order_acquire);
+        if (h - r->tail_seen == EV_RING) {
+            atomic_store_explicit(&r->dropped, atomic_load_explicit(&r->dropped, memory_order_relaxed) + 1,
+                                  memory_order_relaxed);
+            return;
+        }
+    }
+    Event *e = &r->ev[h & (EV_RING - 1)];
+    e->game = game; e->time_ms = time_ms;
+    e->type = (uint8_t)type; e->a = (int8_t)a; e->b = (uint16_t)b; e->c = c;
+    atomic_store_explicit(&r->head, h + 1, memory_order_release);
+}
+
+// start the log thread, appending to path every flush_ms; -1 with errno set
+int ev_log_start(const char *path, int flush_ms);
+// a new ring for the calling thread, drained by the log thread from now
+// on; NULL if there is no log or no memory. Rings live until ev_log_stop().
+EvRing *ev_attach(void);
+
+typedef struct {
+    long events, dropped, bytes, batches;
+} EvLogStats;
+
+// drain everything emitted so far, stop the thread and close the log
+void ev_log_stop(EvLogStats *st);
+
+#endif
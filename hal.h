@@ -0,0 +1,85 @@
+// hal.h — device access for newtetris.c
+// The DE10-Lite build talks to the memory-mapped devices directly through
+// the inline functions below. Building with -DHAL_HOST swaps them for the
+// emulated devices in hal_host.c, so the same game and render code runs
+// (and can be profiled and regression-tested) on a workstation.
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+
+#define HAL_CPU_HZ        30000000   // DTEK-V core clock, drives the timer
+#define HAL_VGA_W         320
+#define HAL_VGA_H         240
+#define HAL_VGA_PAGE_SIZE (HAL_VGA_W * HAL_VGA_H)
+#define HAL_IRQ_TIMER     16         // cause passed to handle_interrupt()
+
+// provided by the program; called from the trap handler in the boot code
+// (board) or by the device emulator (host)
+void handle_interrupt(unsigned cause);
+
+#ifdef HAL_HOST
+
+void hal_init(void);
+void hal_timer_init(unsigned period, int irq);
+int hal_timer_timeout(void);
+void hal_timer_ack(void);
+void hal_irq_enable(void);
+void hal_wait_for_interrupt(void);
+unsigned hal_switches(void);
+unsigned hal_button(void);
+volatile uint8_t *hal_vga_page(int page);
+void hal_vga_swap(volatile uint8_t *page);
+int hal_vga_swap_pending(void);
+
+#else
+
+#define HAL_SWITCHES ((volatile unsigned int *)0x04000010)
+#define HAL_TIMER    ((volatile unsigned int *)0x04000020) // status, control, periodl, periodh
+#define HAL_BUTTON   ((volatile unsigned int *)0x040000d0)
+#define HAL_VGA_CTRL ((volatile unsigned int *)0x04000100) // buffer, backbuffer, resolution, status
+#define HAL_VGA_FB   0x08000000                            // two pages of HAL_VGA_PAGE_SIZE
+
+static inline void hal_init(void) {}
+
+// period in core clock cycles, minus one; irq != 0 raises HAL_IRQ_TIMER on timeout
+static inline void hal_timer_init(unsigned period, int irq) {
+    HAL_TIMER[2] = period & 0xffff;
+    HAL_TIMER[3] = (period >> 16) & 0xffff;
+    HAL_TIMER[1] = irq ? 0x7 : 0x6;  // [ITO |] CONT | START
+}
+
+// 1 (and acknowledge) if the timer ran out since the last call
+static inline int hal_timer_timeout(void) {
+    if (!(HAL_TIMER[0] & 0x1)) return 0;
+    HAL_TIMER[0] = 0;
+    return 1;
+}
+
+static inline void hal_timer_ack(void) { HAL_TIMER[0] = 0; }
+
+static inline void hal_irq_enable(void) {
+    __asm__ volatile ("csrs mie, %0" :: "r"(1u << HAL_IRQ_TIMER));
+    __asm__ volatile ("csrsi mstatus, 8");   // MIE
+}
+
+static inline void hal_wait_for_interrupt(void) { __asm__ volatile ("wfi"); }
+
+static inline unsigned hal_switches(void) { return *HAL_SWITCHES & 0x3ff; }
+static inline unsigned hal_button(void)   { return *HAL_BUTTON & 0x1; }
+
+static inline volatile uint8_t *hal_vga_page(int page) {
+    return (volatile uint8_t *)(uintptr_t)(HAL_VGA_FB + page * HAL_VGA_PAGE_SIZE);
+}
+
+// show page from the next vertical sync on
+static inline void hal_vga_swap(volatile uint8_t *page) {
+    HAL_VGA_CTRL[1] = (uint32_t)(uintptr_t)page; // backbuffer register
+    HAL_VGA_CTRL[0] = 0;                         // writing buffer requests the swap
+}
+
+static inline int hal_vga_swap_pending(void) { return HAL_VGA_CTRL[3] & 0x1; }
+
+#endif
+
+#endif
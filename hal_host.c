@@ -0,0 +1,284 @@
+// hal_host.c — emulated DE10-Lite devices for running newtetris.c on a PC
+// build: gcc -O2 -std=c11 -DHAL_HOST newtetris.c hal_host.c -o newtetris-host
+// run:   TETRIS_SCRIPT=play.txt TETRIS_DUMP=frame ./newtetris-host
+//
+// Environment:
+//   TETRIS_SCRIPT      input script, one "<ms> <command> [value]" per line:
+//                        sw <n>    set the switches to n
+//                        btn <0|1> release/press the button
+//                        dump      write the frame on screen
+//                        quit      stop the run
+//                      without a script the button is pressed for the first ms
+//   TETRIS_DUMP        PPM path prefix, frames go to <prefix>NNNNNN.ppm
+//   TETRIS_DUMP_EVERY  also dump every Nth presented frame (default: only
+//                      on "dump" and at exit)
+//   TETRIS_MAX_MS      stop after this much virtual time (default 600000)
+//   TETRIS_CAPTURE     stream every presented frame to this file, delta
+//                      encoded (see tcap.h; decode with tcap2ppm)
+//
+// Time is virtual: it advances by HOST_ACCESS_NS whenever the program touches
+// a device, and jumps to the next timer timeout on hal_wait_for_interrupt(),
+// so a run is deterministic and goes as fast as the host allows. A pending
+// timer interrupt is delivered at the next device access once enabled.
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hal.h"
+#include "tcap.h"
+
+#define HOST_ACCESS_NS 1000          // cost of one bus access to a device
+#define MAX_EVENTS     4096
+
+typedef enum { EV_SW, EV_BTN, EV_DUMP, EV_QUIT } EventKind;
+typedef struct { uint64_t at_ns; EventKind kind; unsigned value; } Event;
+
+static uint64_t now_ns;
+static uint64_t max_ns = 600000ull * 1000000ull;
+static uint64_t timer_period_ns, timer_next_ns;
+static int timer_running, timer_irq, timer_to;     // TO is a single sticky bit
+static int irq_enabled, in_irq;
+static long irqs, lost_ticks;                      // lost: timeouts while TO was set
+
+static unsigned switches, button;
+static Event events[MAX_EVENTS];
+static int n_events, next_event;
+
+static uint8_t vga_mem[2][HAL_VGA_PAGE_SIZE];
+static int vga_front;
+static long frames;
+
+static const char *dump_prefix;
+static long dump_every, dumps;
+static struct timespec host_start;
+
+static double host_ms_since(const struct timespec *t0) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (t.tv_sec - t0->tv_sec) * 1e3 + (t.tv_nsec - t0->tv_nsec) / 1e6;
+}
+
+// ============================= FRAME DUMPS =======================
+static void dump_frame(void) {
+    if (!dump_prefix) return;
+    char path[512];
+    snprintf(path, sizeof path, "%s%06ld.ppm", dump_prefix, dumps++);
+    FILE *f = fopen(path, "wb");
+    if (!f) { perror(path); return; }
+    fprintf(f, "P6\n%d %d\n255\n", HAL_VGA_W, HAL_VGA_H);
+    static uint8_t rgb[HAL_VGA_PAGE_SIZE * 3];
+    tcap_to_rgb(vga_mem[vga_front], HAL_VGA_PAGE_SIZE, rgb);
+    fwrite(rgb, 1, sizeof rgb, f);
+    fclose(f);
+}
+
+// ============================= CAPTURE ===========================
+static FILE *cap_file;
+static uint8_t cap_prev[HAL_VGA_PAGE_SIZE];        // last captured frame
+static uint8_t cap_buf[8 + HAL_VGA_PAGE_SIZE * 2];  // frame header + worst-case payload
+static long cap_bytes;
+static double cap_ms;                               // host time spent encoding
+
+static void capture_open(const char *path) {
+    cap_file = fopen(path, "wb");
+    if (!cap_file) { perror(path); exit(1); }
+    uint8_t hdr[12];
+    memcpy(hdr, TCAP_MAGIC, 4);
+    tcap_put_u16(hdr + 4, TCAP_VERSION);
+    tcap_put_u16(hdr + 6, HAL_VGA_W);
+    tcap_put_u16(hdr + 8, HAL_VGA_H);
+    tcap_put_u16(hdr + 10, 0);
+    fwrite(hdr, 1, sizeof hdr, cap_file);
+    cap_bytes = sizeof hdr;
+}
+
+static int is_run4(const uint8_t *px, int k, int end) {
+    return k + 3 < end && px[k] == px[k + 1] && px[k] == px[k + 2] && px[k] == px[k + 3];
+}
+
+// encode [i, end) of px as FILL/COPY ops into p
+static size_t capture_span(uint8_t *p, const uint8_t *px, int i, int end) {
+    size_t n = 0;
+    while (i < end) {
+        if (is_run4(px, i, end)) {
+            int r = i + 4;
+            while (r < end && px[r] == px[i]) r++;
+            n += tcap_put_varint(p + n, (uint32_t)(r - i) << 2 | TCAP_FILL);
+            p[n++] = px[i];
+            i = r;
+        } else {
+            int k = i + 1;
+            while (k < end && !is_run4(px, k, end)) k++;
+            n += tcap_put_varint(p + n, (uint32_t)(k - i) << 2 | TCAP_COPY);
+            memcpy(p + n, px + i, (size_t)(k - i));
+            n += (size_t)(k - i);
+            i = k;
+        }
+    }
+    return n;
+}
+
+// delta of px against cap_prev; cap_prev is brought up to date on the way
+static size_t capture_encode(const uint8_t *px, uint8_t *p) {
+    const int N = HAL_VGA_PAGE_SIZE;
+    size_t n = 0;
+    int i = 0, done = 0;                 // done: first pixel not yet covered by ops
+    while (i < N) {
+        uint64_t a, b;                   // skip unchanged pixels 8 at a time
+        while (i + 8 <= N && (memcpy(&a, px + i, 8), memcpy(&b, cap_prev + i, 8), a == b)) i += 8;
+        while (i < N && px[i] == cap_prev[i]) i++;
+        if (i >= N) break;
+
+        int end = i + 1, same = 0;       // changed span ends at 4 unchanged pixels
+        for (int k = i + 1; k < N && same < 4; ++k) {
+            if (px[k] == cap_prev[k]) same++;
+            else { same = 0; end = k + 1; }
+        }
+        if (i > done) n += tcap_put_varint(p + n, (uint32_t)(i - done) << 2 | TCAP_SKIP);
+        n += capture_span(p + n, px, i, end);
+        memcpy(cap_prev + i, px + i, (size_t)(end - i));
+        done = i = end;
+    }
+    return n;
+}
+
+static void capture_frame(void) {
+    struct timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    size_t n = capture_encode(vga_mem[vga_front], cap_buf + 8);
+    tcap_put_u32(cap_buf, (uint32_t)(now_ns / 1000000ull));
+    tcap_put_u32(cap_buf + 4, (uint32_t)n);
+    fwrite(cap_buf, 1, n + 8, cap_file);
+    cap_bytes += (long)n + 8;
+    cap_ms += host_ms_since(&t0);
+}
+
+static void finish(void) {
+    double host_ms = host_ms_since(&host_start);
+    dump_frame();
+    fprintf(stderr, "host: %.0f virtual ms, %ld frames, %.1f host ms (%.2f us/frame)\n",
+            now_ns / 1e6, frames, host_ms, frames ? host_ms * 1e3 / frames : 0.0);
+    if (irqs || lost_ticks)
+        fprintf(stderr, "timer: %ld interrupts, %ld ticks lost\n", irqs, lost_ticks);
+    if (cap_file) {
+        fclose(cap_file);
+        fprintf(stderr, "capture: %ld bytes (%.1f B/frame), encode %.2f us/frame\n",
+                cap_bytes, frames ? (double)cap_bytes / frames : 0.0,
+                frames ? cap_ms * 1e3 / frames : 0.0);
+    }
+}
+
+// ============================= VIRTUAL CLOCK =====================
+static void advance(uint64_t ns) {
+    now_ns += ns;
+    while (timer_running && timer_next_ns <= now_ns) {
+        if (timer_to) lost_ticks++;
+        timer_to = 1;
+        timer_next_ns += timer_period_ns;
+    }
+    while (next_event < n_events && events[next_event].at_ns <= now_ns) {
+        Event *e = &events[next_event++];
+        switch (e->kind) {
+            case EV_SW:   switches = e->value & 0x3ff; break;
+            case EV_BTN:  button = e->value & 0x1;     break;
+            case EV_DUMP: dump_frame();                break;
+            case EV_QUIT: exit(0);
+        }
+    }
+    if (now_ns >= max_ns) exit(0);
+
+    if (timer_to && timer_irq && irq_enabled && !in_irq) {
+        in_irq = 1;
+        irqs++;
+        handle_interrupt(HAL_IRQ_TIMER);
+        in_irq = 0;
+    }
+}
+
+static void load_script(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) { perror(path); exit(1); }
+    char line[256], cmd[16];
+    double ms;
+    unsigned value;
+    while (fgets(line, sizeof line, f)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        value = 0;
+        if (sscanf(line, "%lf %15s %u", &ms, cmd, &value) < 2) continue;
+        if (n_events == MAX_EVENTS) { fprintf(stderr, "%s: too many events\n", path); exit(1); }
+        Event *e = &events[n_events++];
+        e->at_ns = (uint64_t)(ms * 1e6);
+        e->value = value;
+        if (strcmp(cmd, "sw") == 0) e->kind = EV_SW;
+        else if (strcmp(cmd, "btn") == 0) e->kind = EV_BTN;
+        else if (strcmp(cmd, "dump") == 0) e->kind = EV_DUMP;
+        else if (strcmp(cmd, "quit") == 0) e->kind = EV_QUIT;
+        else { fprintf(stderr, "%s: unknown command '%s'\n", path, cmd); exit(1); }
+        if (n_events > 1 && e->at_ns < e[-1].at_ns) {
+            fprintf(stderr, "%s: events must be in time order\n", path);
+            exit(1);
+        }
+    }
+    fclose(f);
+}
+
+// ============================= DEVICES ===========================
+void hal_init(void) {
+    const char *s;
+    if ((s = getenv("TETRIS_MAX_MS"))) max_ns = strtoull(s, NULL, 10) * 1000000ull;
+    if ((s = getenv("TETRIS_DUMP_EVERY"))) dump_every = atol(s);
+    dump_prefix = getenv("TETRIS_DUMP");
+    if ((s = getenv("TETRIS_CAPTURE"))) capture_open(s);
+    if ((s = getenv("TETRIS_SCRIPT"))) load_script(s);
+    else {                               // get past the seed prompt
+        events[0] = (Event){ 0, EV_BTN, 1 };
+        events[1] = (Event){ 1000000, EV_BTN, 0 };
+        n_events = 2;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &host_start);
+    atexit(finish);
+    advance(0);
+}
+
+void hal_timer_init(unsigned period, int irq) {
+    // the interval timer counts period..0, i.e. period + 1 cycles
+    timer_period_ns = ((uint64_t)period + 1) * 1000000000ull / HAL_CPU_HZ;
+    timer_next_ns = now_ns + timer_period_ns;
+    timer_running = 1;
+    timer_irq = irq;
+    timer_to = 0;
+    advance(HOST_ACCESS_NS);
+}
+
+int hal_timer_timeout(void) {
+    advance(HOST_ACCESS_NS);
+    if (!timer_to) return 0;
+    timer_to = 0;
+    return 1;
+}
+
+void hal_timer_ack(void) { timer_to = 0; advance(HOST_ACCESS_NS); }
+
+void hal_irq_enable(void) { irq_enabled = 1; advance(0); }
+
+void hal_wait_for_interrupt(void) {
+    if (!timer_running || !timer_irq || !irq_enabled) { advance(HOST_ACCESS_NS); return; }
+    if (!timer_to) advance(timer_next_ns - now_ns);   // sleep until the next timeout
+    else advance(0);
+}
+
+unsigned hal_switches(void) { advance(HOST_ACCESS_NS); return switches; }
+unsigned hal_button(void)   { advance(HOST_ACCESS_NS); return button; }
+
+volatile uint8_t *hal_vga_page(int page) { return vga_mem[page & 1]; }
+
+void hal_vga_swap(volatile uint8_t *page) {
+    advance(HOST_ACCESS_NS);
+    vga_front = page == vga_mem[1];      // no vsync wait: the swap is immediate
+    frames++;
+    if (cap_file) capture_frame();
+    if (dump_every && frames % dump_every == 0) dump_frame();
+}
+
+int hal_vga_swap_pending(void) { advance(HOST_ACCESS_NS); return 0; }
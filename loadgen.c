@@ -0,0 +1,236 @@
+// loadgen.c — loopback load test for server.c
+// build: gcc -O2 -std=c11 -pthread loadgen.c -o loadgen
+// run:   ./server -p 7000 -w 2 &  ./loadgen -p 7000 -c 4000 -t 2 -d 10
+//
+// Opens many sessions, each sending inputs at a steady rate like a player
+// would (mostly moves and rotations, now and then a hard drop), and times
+// the round trip from an input to the STATE that echoes its sequence number.
+// Gravity keeps the server sending on its own in between.
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "rng.h"
+#include "proto.h"
+
+// ============================= TIMING ============================
+static long now_us(void) {
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)(ts.tv_sec*1000000LL + ts.tv_nsec/1000LL);
+}
+
+// ============================= OPTIONS ===========================
+static int opt_port = 0;
+static const char *opt_unix = NULL;
+static const char *opt_host = "127.0.0.1";
+static int opt_sessions = 1000;
+static int opt_threads = 1;
+static int opt_seconds = 10;
+static int opt_rate = 10;            // inputs per second per session
+static int opt_rules = 1;            // 0 8x8, 1 10x20
+static uint64_t opt_seed = 1;
+
+// ============================= SESSIONS ==========================
+#define RTT_BUCKETS 5000             // 10 us each
+
+typedef struct {
+    int fd;
+    uint16_t seq, acked;
+    long next_us;                    // when the next input goes out
+    long sent_us[64];                // by seq & 63
+    int in_len;
+    uint8_t in[512];
+} Client;
+
+typedef struct {
+    int first, last;
+    pthread_t tid;
+    long inputs, states, games, rtt_n, rtt_max, errors;
+    long rtt[RTT_BUCKETS + 1];
+} Shard;
+
+static Client *clients;
+
+static int connect_one(void) {
+    int fd;
+    if (opt_unix) {
+        struct sockaddr_un a = { .sun_family = AF_UNIX };
+        snprintf(a.sun_path, sizeof a.sun_path, "%s", opt_unix);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (connect(fd, (struct sockaddr *)&a, sizeof a) < 0) { close(fd); return -1; }
+    } else {
+        struct sockaddr_in a = { .sin_family = AF_INET, .sin_port = htons((uint16_t)opt_port) };
+        inet_pton(AF_INET, opt_host, &a.sin_addr);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (connect(fd, (struct sockaddr *)&a, sizeof a) < 0) { close(fd); return -1; }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    }
+    return fd;
+}
+
+static void on_state(Shard *sh, Client *c, const MsgState *m, long now) {
+    sh->states++;
+    if (m->flags & STATE_OVER) sh->games++;
+    // only the first echo of a sequence number counts; gravity states repeat it
+    if (m->seq != c->acked && (uint16_t)(c->seq - m->seq) < 64) {
+        long rtt = now - c->sent_us[m->seq & 63];
+        c->acked = m->seq;
+        sh->rtt[rtt / 10 < RTT_BUCKETS ? rtt / 10 : RTT_BUCKETS]++;
+        sh->rtt_n++;
+        if (rtt > sh->rtt_max) sh->rtt_max = rtt;
+    }
+}
+
+// mostly moves and rotations, sometimes a soft or hard drop
+static uint8_t pick_action(Rng *r) {
+    static const uint8_t mix[16] = {
+        ACT_LEFT, ACT_LEFT, ACT_LEFT, ACT_LEFT, ACT_RIGHT, ACT_RIGHT, ACT_RIGHT, ACT_RIGHT,
+        ACT_ROTATE, ACT_ROTATE, ACT_ROTATE, ACT_SOFT_DROP, ACT_SOFT_DROP, ACT_NONE,
+        ACT_HARD_DROP, ACT_HARD_DROP,
+    };
+    return mix[rng_below(r, 16)];
+}
+
+static void *shard_main(void *arg) {
+    Shard *sh = arg;
+    int ep = epoll_create1(0);
+    Rng rng;
+    rng_init(&rng, opt_seed, 1000000u + (uint64_t)sh->first);
+    long period = 1000000L / opt_rate, t0 = now_us();
+
+    for (int i = sh->first; i < sh->last; ++i) {
+        Client *c = &clients[i];
+        uint8_t buf[MSG_HELLO_LEN];
+        MsgHello h = { .rules = (uint8_t)opt_rules, .policy = 0, .level = 0, .seed = opt_seed + (uint64_t)i };
+        msg_put_hello(buf, &h);
+        if (c->fd < 0 || send(c->fd, buf, sizeof buf, MSG_NOSIGNAL) != sizeof buf) {
+            sh->errors++;
+            if (c->fd >= 0) { close(c->fd); c->fd = -1; }
+            continue;
+        }
+        c->next_us = t0 + (long)rng_below(&rng, (uint32_t)period);    // spread the senders out
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = c };
+        epoll_ctl(ep, EPOLL_CTL_ADD, c->fd, &ev);
+    }
+
+    struct epoll_event ev[256];
+    long end = t0 + opt_seconds * 1000000L;
+    for (long now = now_us(); now < end; now = now_us()) {
+        int n = epoll_wait(ep, ev, 256, 1);
+        now = now_us();
+        for (int i = 0; i < n; ++i) {
+            Client *c = ev[i].data.ptr;
+            ssize_t k = recv(c->fd, c->in + c->in_len, sizeof c->in - (size_t)c->in_len, MSG_DONTWAIT);
+            if (k <= 0) {
+                if (k < 0 && errno == EAGAIN) continue;
+                sh->errors++;                                   // once per session: it sends no more
+                close(c->fd);
+                c->fd = -1;
+                continue;
+            }
+            c->in_len += (int)k;
+            int off = 0;
+            while (c->in_len - off >= 2 && c->in_len - off >= c->in[off + 1]) {
+                MsgState m;
+                if (c->in[off] == MSG_STATE && msg_get_state(c->in + off, &m)) on_state(sh, c, &m, now);
+                off += c->in[off + 1] ? c->in[off + 1] : 2;
+            }
+            memmove(c->in, c->in + off, (size_t)(c->in_len - off));
+            c->in_len -= off;
+        }
+        for (int i = sh->first; i < sh->last; ++i) {
+            Client *c = &clients[i];
+            if (c->fd < 0 || now < c->next_us) continue;
+            uint8_t buf[MSG_INPUT_LEN];
+            MsgInput in = { .action = pick_action(&rng), .seq = ++c->seq };
+            msg_put_input(buf, &in);
+            c->sent_us[c->seq & 63] = now;
+            if (send(c->fd, buf, sizeof buf, MSG_NOSIGNAL | MSG_DONTWAIT) == sizeof buf) sh->inputs++;
+            else sh->errors++;
+            c->next_us += period;
+            if (c->next_us < now) c->next_us = now + period;   // fell behind; don't burst
+        }
+    }
+    return NULL;
+}
+
+// ================================ MAIN ===========================
+static long rtt_percentile(const long *h, long total, double q) {
+    if (total <= 0) return 0;
+    long want = (long)(q * total), seen = 0;
+    for (int b = 0; b <= RTT_BUCKETS; ++b)
+        if ((seen += h[b]) > want) return b * 10L;
+    return RTT_BUCKETS * 10L;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s (-p port [-h host] | -u unix_path) [-c sessions] [-t threads]"
+                    " [-d seconds] [-r inputs/s per session] [-R 8x8|10x20] [-s seed]\n", argv0);
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "p:h:u:c:t:d:r:R:s:")) != -1) {
+        switch (opt) {
+            case 'p': opt_port = atoi(optarg); break;
+            case 'h': opt_host = optarg; break;
+            case 'u': opt_unix = optarg; break;
+            case 'c': opt_sessions = atoi(optarg); break;
+            case 't': opt_threads = atoi(optarg); break;
+            case 'd': opt_seconds = atoi(optarg); break;
+            case 'r': opt_rate = atoi(optarg); break;
+            case 'R': opt_rules = strcmp(optarg, "8x8") != 0; break;
+            case 's': opt_seed = strtoull(optarg, NULL, 10); break;
+            default: usage(argv[0]);
+        }
+    }
+    if ((!opt_port && !opt_unix) || opt_sessions < 1 || opt_threads < 1 || opt_rate < 1) usage(argv[0]);
+    if (opt_threads > opt_sessions) opt_threads = opt_sessions;
+
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0) { rl.rlim_cur = rl.rlim_max; setrlimit(RLIMIT_NOFILE, &rl); }
+
+    clients = calloc((size_t)opt_sessions, sizeof *clients);
+    Shard *shards = calloc((size_t)opt_threads, sizeof *shards);
+    if (!clients || !shards) { perror("calloc"); return 1; }
+    int connected = 0;
+    for (int i = 0; i < opt_sessions; ++i)
+        if ((clients[i].fd = connect_one()) >= 0) ++connected;
+    fprintf(stderr, "loadgen: %d/%d sessions connected\n", connected, opt_sessions);
+
+    long t0 = now_us();
+    for (int t = 0; t < opt_threads; ++t) {
+        shards[t].first = (int)((long)opt_sessions * t / opt_threads);
+        shards[t].last  = (int)((long)opt_sessions * (t + 1) / opt_threads);
+        pthread_create(&shards[t].tid, NULL, shard_main, &shards[t]);
+    }
+    Shard sum = { 0 };
+    for (int t = 0; t < opt_threads; ++t) {
+        pthread_join(shards[t].tid, NULL);
+        sum.inputs += shards[t].inputs; sum.states += shards[t].states;
+        sum.games += shards[t].games; sum.errors += shards[t].errors;
+        sum.rtt_n += shards[t].rtt_n;
+        if (shards[t].rtt_max > sum.rtt_max) sum.rtt_max = shards[t].rtt_max;
+        for (int b = 0; b <= RTT_BUCKETS; ++b) sum.rtt[b] += shards[t].rtt[b];
+    }
+    double secs = (now_us() - t0) / 1e6;
+    printf("sessions %d  inputs %.0f/s  states %.0f/s  games ended %ld  errors %ld\n"
+           "input->state rtt p50 %ld us  p99 %ld us  p99.9 %ld us  max %ld us  (%ld samples)\n",
+           connected, sum.inputs / secs, sum.states / secs, sum.games, sum.errors,
+           rtt_percentile(sum.rtt, sum.rtt_n, 0.50), rtt_percentile(sum.rtt, sum.rtt_n, 0.99),
+           rtt_percentile(sum.rtt, sum.rtt_n, 0.999), sum.rtt_max, sum.rtt_n);
+    return 0;
+}
@@ -1,18 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include "rng.h"
 
 //array filled with characters
 const char *blocks[] = {"square", "Lleft", "Lright", "zigzagleft", "zigzagright", "straight"};
 
-// unbiased dice roll 1..6 using rejection sampling
-static int roll_d6(void) {
-    const int n = 6;
-    int limit = RAND_MAX - (RAND_MAX % n);
-    int r;
-    do { r = rand(); } while (r >= limit);
-    return (r % n);
-}
-
 // reads a number from the user
 static unsigned int get_seed(void) {
     unsigned int s;
@@ -24,9 +16,12 @@ static unsigned int get_seed(void) {
 
 int main(void) {
     unsigned int s = get_seed();  // ONLY the user input
-    srand(s ? s : 1);             // avoid the (rare) zero edge case
+    Rng rng;
+    rng_init(&rng, s, 0);         // same pieces as game 0 of tetristest.c's seed
+    PieceQueue pieces;
+    pieces_init(&pieces, rng_split(&rng, 0), 6, PIECES_UNIFORM);
     for (int i = 0; i < 10; ++i) {
-        const char *x = blocks[roll_d6()];
+        const char *x = blocks[pieces_next(&pieces)];
         printf("%s\n", x);
     }
     return 0;
@@ -0,0 +1,80 @@
+// metrics.c — creating, claiming and reading a metrics segment (see metrics.h)
+// build: linked into the writer and the reader, e.g.
+//        gcc -O2 -std=c11 -pthread server.c scores.c metrics.c engine.c -o server
+//        gcc -O2 -std=c11 metricstop.c metrics.c -o metricstop
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "metrics.h"
+
+// ============================= Writer ============================
+MetSegment *met_create(const char *path) {
+    char tmp[4096];
+    if (snprintf(tmp, sizeof tmp, "%s.tmp", path) >= (int)sizeof tmp) { errno = ENAMETOOLONG; return NULL; }
+    int fd = open(tmp, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return NULL;
+    if (ftruncate(fd, sizeof(MetSegment)) < 0) { int e = errno; close(fd); unlink(tmp); errno = e; return NULL; }
+    MetSegment *m = mmap(NULL, sizeof *m, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) { int e = errno; unlink(tmp); errno = e; return NULL; }
+    m->magic = MET_MAGIC;                             // the file starts zeroed
+    m->version = MET_VERSION;
+    m->slots = MET_SLOTS;
+    m->size = sizeof *m;
+    m->pid = (uint32_t)getpid();
+    m->started = (int64_t)time(NULL);
+    if (rename(tmp, path) < 0) { int e = errno; munmap(m, sizeof *m); unlink(tmp); errno = e; return NULL; }
+    return m;
+}
+
+MetSlot *met_claim(MetSegment *m, const char *name) {
+    unsigned i = atomic_fetch_add(&m->used, 1);
+    if (i >= MET_SLOTS) return NULL;
+    MetSlot *s = &m->slot[i];
+    snprintf(s->name, sizeof s->name, "%s", name);
+    atomic_store_explicit(&s->live, 1, memory_order_release);
+    return s;
+}
+
+void met_close(MetSegment *m) {
+    if (m) munmap(m, sizeof *m);                     // the file stays for a last look
+}
+
+// ============================= Reader ============================
+const MetSegment *met_open(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(MetSegment)) { close(fd); errno = EINVAL; return NULL; }
+    const MetSegment *m = mmap(NULL, sizeof *m, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) return NULL;
+    if (m->magic != MET_MAGIC || m->version != MET_VERSION || m->slots != MET_SLOTS || m->size != sizeof *m) {
+        munmap((void *)m, sizeof *m);
+        errno = EINVAL;
+        return NULL;
+    }
+    return m;
+}
+
+void met_unmap(const MetSegment *m) {
+    if (m) munmap((void *)m, sizeof *m);
+}
+
+void met_read(const MetSlot *s, MetValues *out) {
+    for (int tries = 0; ; ++tries) {
+        unsigned s1 = atomic_load_explicit(&s->seq, memory_order_acquire);
+        if ((s1 & 1) && tries < 1000) continue;          // a writer that died mid-group stays odd
+        for (int i = 0; i < MET_N; ++i) out->v[i] = atomic_load_explicit(&s->v[i], memory_order_relaxed);
+        for (int i = 0; i < MET_HIST; ++i)
+            out->frame_hist[i] = atomic_load_explicit(&s->frame_hist[i], memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&s->seq, memory_order_relaxed) == s1 || tries >= 1000) return;
+    }
+}
@@ -0,0 +1,116 @@
+// metrics.h — live counters and gauges in a shared memory segment
+// A process that wants watching maps one MetSegment, a fixed layout in a
+// file (normally under /dev/shm), and each of its threads claims a MetSlot
+// of its own. Only that thread writes the slot, so updating a metric is a
+// relaxed load and one relaxed store: nothing locked, nothing shared, cheap
+// enough to leave on. Where a reader needs values that agree with each
+// other (games ended and the levels they ended on, frames and their time),
+// the writer brackets the group with the slot's sequence number, as in a
+// seqlock, and met_read() retries until it gets a copy from between groups.
+//
+// Readers (metricstop.c) map the file read-only from any process and turn
+// successive reads into rates. The segment is created fresh by each run
+// and renamed into place, so a reader notices a restart by the file's
+// inode and the header's start time.
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define MET_MAGIC   0x5254454Du      // "METR"
+#define MET_VERSION 1
+#define MET_SLOTS   64
+#define MET_HIST    20               // frame times: bucket b < 2^b us, the last open
+
+enum {
+    MET_GAMES,                       // games ended, topped out or abandoned
+    MET_LEVEL_SUM,                   // their levels at the end
+    MET_TOPOUTS,                     // engine: games lost to a full board
+    MET_PIECES,                      // engine: pieces spawned
+    MET_LINES,                       // engine: lines cleared
+    MET_LEVEL_UPS,                   // engine
+    MET_LIVE,                        // gauge: games in play
+    MET_FRAMES,                      // passes of the thread's main loop
+    MET_FRAME_NS,                    // time spent in them
+    MET_N
+};
+
+typedef struct {
+    _Alignas(64) atomic_uint seq;    // odd while the writer is inside a group
+    atomic_uint live;                // set once name is filled in
+    char name[24];
+    _Atomic uint64_t v[MET_N];
+    _Atomic uint64_t frame_hist[MET_HIST];
+} MetSlot;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version, slots;
+    uint32_t size;                   // of the whole segment
+    uint32_t pid;
+    int64_t started;                 // unix time the writer created it
+    atomic_uint used;                // slots claimed so far
+    MetSlot slot[MET_SLOTS];
+} MetSegment;
+
+// -------- writer side: only the slot's own thread calls these --------
+static inline void met_add(MetSlot *s, int m, uint64_t v) {
+    atomic_store_explicit(&s->v[m], atomic_load_explicit(&s->v[m], memory_order_relaxed) + v,
+                          memory_order_relaxed);
+}
+
+static inline void met_set(MetSlot *s, int m, uint64_t v) {
+    atomic_store_explicit(&s->v[m], v, memory_order_relaxed);
+}
+
+static inline void met_begin(MetSlot *s) {
+    atomic_store_explicit(&s->seq, atomic_load_explicit(&s->seq, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void met_end(MetSlot *s) {
+    atomic_store_explicit(&s->seq, atomic_load_explicit(&s->seq, memory_order_relaxed) + 1,
+                          memory_order_release);
+}
+
+static inline void met_game_end(MetSlot *s, int level) {
+    met_begin(s);
+    met_add(s, MET_GAMES, 1);
+    met_add(s, MET_LEVEL_SUM, (uint64_t)level);
+    met_end(s);
+}
+
+static inline void met_frame(MetSlot *s, long ns) {
+    int b = 0;
+    for (long us = ns >> 10; us && b < MET_HIST - 1; us >>= 1) ++b;  // ~us, no division
+    met_begin(s);
+    met_add(s, MET_FRAMES, 1);
+    met_add(s, MET_FRAME_NS, (uint64_t)ns);
+    atomic_store_explicit(&s->frame_hist[b], atomic_load_explicit(&s->frame_hist[b], memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+    met_end(s);
+}
+
+// create the segment at path (replacing any old one) and map it; NULL with
+// errno set
+MetSegment *met_create(const char *path);
+// a slot for the calling thread, named for the reader; NULL when all taken
+MetSlot *met_claim(MetSegment *m, const char *name);
+void met_close(MetSegment *m);
+
+// -------- reader side --------
+// map a segment read-only; NULL with errno set (EINVAL: not a segment)
+const MetSegment *met_open(const char *path);
+void met_unmap(const MetSegment *m);
+
+typedef struct {
+    uint64_t v[MET_N];
+    uint64_t frame_hist[MET_HIST];
+} MetValues;
+
+// a consistent copy of one slot
+void met_read(const MetSlot *s, MetValues *out);
+
+#endif
@@ -0,0 +1,164 @@
+// metricstop.c — live rates from a metrics segment (metrics.h)
+// build: gcc -O2 -std=c11 metricstop.c metrics.c -o metricstop
+// run:   ./metricstop /dev/shm/tetris.metrics        (-i seconds, -n reports, -s per slot)
+//
+// Maps the segment read-only, reads every claimed slot each interval and
+// prints what changed: games ended and top-outs per second, the share of
+// games that topped out, their average level at the end, pieces and lines
+// per second, games in play, and how long the writers' loop passes took.
+// It never writes to the segment, so any number can watch at once. When
+// the writer restarts (a new file or a new start time) it maps the new
+// segment and starts counting again.
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include "metrics.h"
+
+// ============================= OPTIONS ===========================
+static double opt_interval = 1.0;
+static long opt_reports = 0;         // 0: until interrupted
+static int opt_slots = 0;            // -s: a line per slot as well
+
+static long now_ns(void) {
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)(ts.tv_sec*1000000000LL + ts.tv_nsec);
+}
+
+// ============================= READING ===========================
+typedef struct {
+    const MetSegment *m;
+    ino_t ino;
+    int64_t started;
+    MetValues prev[MET_SLOTS];
+    long prev_ns;
+} Watch;
+
+static int watch_open(Watch *w, const char *path) {
+    struct stat st;
+    if (stat(path, &st) < 0) return -1;
+    const MetSegment *m = met_open(path);
+    if (!m) return -1;
+    met_unmap(w->m);
+    memset(w, 0, sizeof *w);
+    w->m = m;
+    w->ino = st.st_ino;
+    w->started = m->started;
+    w->prev_ns = now_ns() - (long)((time(NULL) - m->started) * 1000000000LL);  // the first report: since it started
+    return 0;
+}
+
+static int watch_stale(const Watch *w, const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 && st.st_ino != w->ino;
+}
+
+static unsigned slots_used(const MetSegment *m) {
+    unsigned n = atomic_load_explicit(&m->used, memory_order_acquire);
+    return n < MET_SLOTS ? n : MET_SLOTS;
+}
+
+// upper edge of the bucket holding the q-th frame, in us
+static long hist_percentile(const uint64_t *h, double q) {
+    uint64_t total = 0, seen = 0;
+    for (int b = 0; b < MET_HIST; ++b) total += h[b];
+    if (!total) return 0;
+    uint64_t want = (uint64_t)(q * (double)total);
+    for (int b = 0; b < MET_HIST; ++b)
+        if ((seen += h[b]) > want) return 1L << b;
+    return 1L << (MET_HIST - 1);
+}
+
+static void print_line(const char *who, const MetValues *d, uint64_t live, double secs) {
+    double games = (double)d->v[MET_GAMES];
+    double frames = (double)d->v[MET_FRAMES];
+    char share[16] = "-", level[16] = "-";
+    if (games > 0) {
+        snprintf(share, sizeof share, "%.1f%%", 100.0 * (double)d->v[MET_TOPOUTS] / games);
+        snprintf(level, sizeof level, "%.2f", (double)d->v[MET_LEVEL_SUM] / games);
+    }
+    printf("%-10s %9.1f %9.1f %7s %6s %10.0f %9.0f %7llu %9.0f %7.1f %6ld %6ld\n",
+           who, games / secs, d->v[MET_TOPOUTS] / secs, share, level,
+           d->v[MET_PIECES] / secs, d->v[MET_LINES] / secs, (unsigned long long)live,
+           frames / secs, frames > 0 ? (double)d->v[MET_FRAME_NS] / frames / 1000.0 : 0.0,
+           hist_percentile(d->frame_hist, 0.50), hist_percentile(d->frame_hist, 0.99));
+}
+
+static void report(Watch *w) {
+    long t = now_ns();
+    double secs = (t - w->prev_ns) / 1e9;
+    if (secs < 1e-3) secs = 1e-3;
+    w->prev_ns = t;
+    MetValues sum, cur, d;
+    memset(&sum, 0, sizeof sum);
+    uint64_t live = 0;
+    unsigned n = slots_used(w->m);
+    for (unsigned i = 0; i < n; ++i) {
+        const MetSlot *s = &w->m->slot[i];
+        if (!atomic_load_explicit(&s->live, memory_order_acquire)) continue;
+        met_read(s, &cur);
+        for (int k = 0; k < MET_N; ++k) d.v[k] = cur.v[k] - w->prev[i].v[k];
+        for (int b = 0; b < MET_HIST; ++b) d.frame_hist[b] = cur.frame_hist[b] - w->prev[i].frame_hist[b];
+        d.v[MET_LIVE] = cur.v[MET_LIVE];                 // a gauge, not a count
+        w->prev[i] = cur;
+        for (int k = 0; k < MET_N; ++k) sum.v[k] += d.v[k];
+        for (int b = 0; b < MET_HIST; ++b) sum.frame_hist[b] += d.frame_hist[b];
+        live += cur.v[MET_LIVE];
+        if (opt_slots) print_line(s->name, &d, cur.v[MET_LIVE], secs);
+    }
+    print_line(opt_slots ? "all" : "", &sum, live, secs);
+    fflush(stdout);
+}
+
+// ================================ MAIN ===========================
+static volatile sig_atomic_t quit;
+static void on_int(int sig) { (void)sig; quit = 1; }
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-i seconds] [-n reports] [-s] segment\n", argv0);
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "i:n:s")) != -1) {
+        switch (opt) {
+            case 'i': opt_interval = atof(optarg); break;
+            case 'n': opt_reports = atol(optarg); break;
+            case 's': opt_slots = 1; break;
+            default: usage(argv[0]);
+        }
+    }
+    if (optind != argc - 1 || opt_interval <= 0 || opt_reports < 0) usage(argv[0]);
+    const char *path = argv[optind];
+    signal(SIGINT, on_int);
+
+    Watch w;
+    memset(&w, 0, sizeof w);
+    if (watch_open(&w, path) < 0) {
+        fprintf(stderr, "%s: %s\n", path, errno == EINVAL ? "not a metrics segment" : strerror(errno));
+        return 1;
+    }
+    printf("segment %s: pid %u, up %lds\n", path, w.m->pid, (long)(time(NULL) - w.started));
+
+    struct timespec ts = { .tv_sec = (time_t)opt_interval,
+                           .tv_nsec = (long)((opt_interval - (long)opt_interval) * 1e9) };
+    for (long k = 0; !quit && (!opt_reports || k < opt_reports); ++k) {
+        if (k % 20 == 0)
+            printf("%-10s %9s %9s %7s %6s %10s %9s %7s %9s %7s %6s %6s\n", "", "games/s", "topouts/s",
+                   "topout", "level", "pieces/s", "lines/s", "live", "frames/s", "avg us", "p50us", "p99us");
+        report(&w);
+        nanosleep(&ts, NULL);
+        if (watch_stale(&w, path) || w.m->started != w.started) {
+            if (watch_open(&w, path) == 0)
+                printf("segment %s: restarted, pid %u\n", path, w.m->pid);
+        }
+    }
+    met_unmap(w.m);
+    return 0;
+}
@@ -0,0 +1,279 @@
+// netplay.c — two-player rollback match between two processes over UDP
+// build: gcc -O2 -std=c11 netplay.c rollback.c engine.c bot.c -o netplay
+// run:   ./netplay -P 0 -l 7100 -r 7101 -L 40 -J 15 -x 5 &
+//        ./netplay -P 1 -l 7101 -r 7100 -L 40 -J 15 -x 5
+//
+// Each peer plays its side with the greedy bot and runs the match through
+// rollback.c. Outgoing datagrams pass a delay line first: -L ms one-way
+// latency, +-J ms jitter (which also reorders) and -x percent loss. Every
+// datagram repeats all inputs the peer has not acknowledged yet, so a lost
+// one costs nothing but time. The peers compare checksums of confirmed
+// frames as they go and print one for the final frame: the same on both
+// sides, and the same whatever -L/-J/-x were, if the simulation is
+// deterministic.
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "rollback.h"
+#include "bot.h"
+#include "proto.h"
+
+// ============================= TIMING ============================
+static long now_us(void) {
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)(ts.tv_sec*1000000LL + ts.tv_nsec/1000LL);
+}
+static long now_ns(void) {
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)(ts.tv_sec*1000000000LL + ts.tv_nsec);
+}
+
+// ============================= OPTIONS ===========================
+static int opt_player = 0;
+static int opt_lport = 7100, opt_rport = 7101;
+static int opt_latency_ms = 0, opt_jitter_ms = 0, opt_loss_pct = 0;
+static int opt_frames = 3600;        // one minute at 60 Hz
+static int opt_frame_ms = 16;
+static int opt_window = 8;           // frames of prediction before stalling
+static int opt_delay = 0;            // local input delay, frames
+static int opt_bot_frames = 3;       // the bots act every this many frames, out of step
+static Rules opt_rules = RULES_10X20;
+static uint64_t opt_seed = 1;
+
+// ============================= DELAY LINE ========================
+#define LINE_LEN 1024
+
+typedef struct {
+    long due_us;
+    int len;
+    uint8_t data[MSG_MAX];
+} Datagram;
+
+static Datagram line[LINE_LEN];
+static int line_count;
+static Rng net_rng;                  // loss and jitter
+static long sent, dropped;
+
+static void line_send(const uint8_t *p, int len) {
+    if (opt_loss_pct && (int)rng_below(&net_rng, 100) < opt_loss_pct) { dropped++; return; }
+    if (line_count == LINE_LEN) { dropped++; return; }
+    long d = opt_latency_ms * 1000L;
+    if (opt_jitter_ms) d += (long)rng_below(&net_rng, (uint32_t)(2 * opt_jitter_ms * 1000 + 1)) - opt_jitter_ms * 1000L;
+    Datagram *dg = &line[line_count++];
+    dg->due_us = now_us() + (d > 0 ? d : 0);
+    dg->len = len;
+    memcpy(dg->data, p, (size_t)len);
+}
+
+// send what is due; returns us until the next one, -1 if the line is empty
+static long line_flush(int fd, const struct sockaddr_in *to) {
+    long now = now_us(), next = -1;
+    for (int i = 0; i < line_count; ) {
+        if (line[i].due_us <= now) {
+            sendto(fd, line[i].data, (size_t)line[i].len, 0, (const struct sockaddr *)to, sizeof *to);
+            sent++;
+            line[i] = line[--line_count];
+            continue;
+        }
+        if (next < 0 || line[i].due_us - now < next) next = line[i].due_us - now;
+        ++i;
+    }
+    return next;
+}
+
+// ============================= PEER ==============================
+static Rollback rb;
+static Bot bot;
+static int remote;
+static uint32_t remote_has;          // the peer has our inputs below this frame
+static long desyncs, checks, stalls, rollback_ns, rollback_max_ns;
+static atomic_int quit;
+
+static void on_int(int sig) { (void)sig; atomic_store(&quit, 1); }
+
+static void send_inputs(void) {
+    MsgInputs m = { .player = (uint8_t)opt_player, .start = remote_has,
+                    .ack = rb.confirmed[remote] };
+    uint32_t end = rb.confirmed[opt_player];
+    if (end - m.start > MSG_INPUTS_MAX) end = m.start + MSG_INPUTS_MAX;
+    m.n = (uint8_t)(end - m.start);
+    for (uint32_t f = m.start; f < end; ++f) m.actions[f - m.start] = rb.input[f & (RB_RING - 1)][opt_player];
+    uint32_t cf = rb_confirmed_frame(&rb);
+    if (cf && cf == rb.cur.frame) --cf;  // the newest saved frame
+    m.check_frame = cf;
+    m.checksum = rb_checksum_at(&rb, cf);
+    uint8_t buf[MSG_MAX];
+    line_send(buf, msg_put_inputs(buf, &m));
+}
+
+static void on_inputs(const MsgInputs *m) {
+    if (m->player != remote) return;
+    if (m->ack > remote_has) remote_has = m->ack;
+    for (int i = 0; i < m->n; ++i)
+        if (!rb_add_remote(&rb, remote, m->start + (uint32_t)i, m->actions[i])) break;
+    uint64_t mine = m->checksum ? rb_checksum_at(&rb, m->check_frame) : 0;
+    if (mine) {
+        checks++;
+        if (mine != m->checksum && desyncs++ == 0)
+            fprintf(stderr, "netplay: DESYNC at frame %u\n", m->check_frame);
+    }
+}
+
+static void step_frame(void) {
+    const Game *g = &rb.cur.g[opt_player];
+    uint8_t action = ACT_NONE;
+    if ((rb.cur.frame + (uint32_t)opt_player) % (uint32_t)opt_bot_frames == 0) action = (uint8_t)bot_next_action(&bot, g);
+    rb_add_local(&rb, action);
+    long t = now_ns();
+    long before = rb.rollbacks;
+    rb_advance(&rb);
+    if (rb.rollbacks != before) {
+        long dt = now_ns() - t;
+        rollback_ns += dt;
+        if (dt > rollback_max_ns) rollback_max_ns = dt;
+    }
+}
+
+// how long a snapshot save and restore of the whole match take
+static void bench_snapshot(void) {
+    enum { N = 200000 };
+    long t = now_ns();
+    for (int i = 0; i < N; ++i) {
+        rb.saved[i & (RB_RING - 1)] = rb.cur;
+        __asm__ volatile("" ::: "memory");
+    }
+    long save = now_ns() - t;
+    Match m = rb.cur;
+    t = now_ns();
+    for (int i = 0; i < N; ++i) {
+        rb.cur = rb.saved[i & (RB_RING - 1)];
+        __asm__ volatile("" ::: "memory");
+    }
+    long restore = now_ns() - t;
+    rb.cur = m;
+    fprintf(stderr, "snapshot %zu B: save %.0f ns, restore %.0f ns\n",
+            sizeof(Match), (double)save / N, (double)restore / N);
+}
+
+// ================================ MAIN ===========================
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s -P 0|1 [-l local_port] [-r remote_port] [-L latency_ms]"
+                    " [-J jitter_ms] [-x loss_%%] [-n frames] [-f frame_ms] [-w window]"
+                    " [-D input_delay] [-b bot_frames] [-R 8x8|10x20] [-s seed]\n", argv0);
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "P:l:r:L:J:x:n:f:w:D:b:R:s:")) != -1) {
+        switch (opt) {
+            case 'P': opt_player = atoi(optarg); break;
+            case 'l': opt_lport = atoi(optarg); break;
+            case 'r': opt_rport = atoi(optarg); break;
+            case 'L': opt_latency_ms = atoi(optarg); break;
+            case 'J': opt_jitter_ms = atoi(optarg); break;
+            case 'x': opt_loss_pct = atoi(optarg); break;
+            case 'n': opt_frames = atoi(optarg); break;
+            case 'f': opt_frame_ms = atoi(optarg); break;
+            case 'w': opt_window = atoi(optarg); break;
+            case 'D': opt_delay = atoi(optarg); break;
+            case 'b': opt_bot_frames = atoi(optarg); break;
+            case 'R': opt_rules = strcmp(optarg, "8x8") == 0 ? RULES_8X8 : RULES_10X20; break;
+            case 's': opt_seed = strtoull(optarg, NULL, 10); break;
+            default: usage(argv[0]);
+        }
+    }
+    if ((opt_player != 0 && opt_player != 1) || opt_frames < 1 || opt_frame_ms < 1 ||
+        opt_bot_frames < 1 || opt_loss_pct < 0 || opt_loss_pct >= 100) usage(argv[0]);
+    remote = 1 - opt_player;
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in me = { .sin_family = AF_INET, .sin_port = htons((uint16_t)opt_lport) };
+    struct sockaddr_in peer = { .sin_family = AF_INET, .sin_port = htons((uint16_t)opt_rport) };
+    inet_pton(AF_INET, "127.0.0.1", &me.sin_addr);
+    inet_pton(AF_INET, "127.0.0.1", &peer.sin_addr);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&me, sizeof me) < 0) { perror("udp"); return 1; }
+    signal(SIGINT, on_int);
+
+    rb_init(&rb, 2, opt_player, opt_rules, opt_seed, opt_frame_ms, opt_window, opt_delay);
+    bot_init(&bot, NULL);
+    rng_init(&net_rng, opt_seed, 100 + (uint64_t)opt_player);
+    bench_snapshot();
+
+    // both peers start on their first datagram from the other, so neither
+    // begins a second of prediction ahead
+    long t0 = 0, last_report = now_us(), linger_until = 0, sent_at = 0;
+    uint32_t sent_local = 0, sent_ack = 0;
+    uint32_t target = (uint32_t)opt_frames;
+    while (!atomic_load(&quit)) {
+        uint8_t buf[MSG_MAX + 1];
+        ssize_t k;
+        while ((k = recv(fd, buf, sizeof buf, MSG_DONTWAIT)) > 0) {
+            MsgInputs m;
+            if (msg_get_inputs(buf, (int)k, &m)) {
+                on_inputs(&m);
+                if (!t0) t0 = now_us();
+            }
+        }
+
+        long now = now_us();
+        if (t0) {
+            uint32_t due = (uint32_t)((now - t0) / (opt_frame_ms * 1000L));
+            if (due > target) due = target;
+            while (rb.cur.frame < due) {
+                if (!rb_can_advance(&rb)) { stalls++; break; }
+                step_frame();
+            }
+        }
+        // new inputs or acks go out at once, otherwise once a frame
+        if (rb.confirmed[opt_player] != sent_local || rb.confirmed[remote] != sent_ack ||
+            now - sent_at >= opt_frame_ms * 1000L) {
+            send_inputs();
+            sent_local = rb.confirmed[opt_player];
+            sent_ack = rb.confirmed[remote];
+            sent_at = now;
+        }
+        long next_dg = line_flush(fd, &peer);
+
+        int finished = rb.cur.frame == target && rb.confirmed[remote] >= target && remote_has >= target;
+        if (finished && !linger_until)       // keep acknowledging while the peer finishes
+            linger_until = now + 500000L + 4000L * (opt_latency_ms + opt_jitter_ms);
+        if (linger_until && now >= linger_until) break;
+
+        if (now - last_report >= 1000000L) {
+            last_report = now;
+            fprintf(stderr, "P%d frame %u  confirmed %u  rollbacks %ld (avg %.1f, max %ld frames)  stalls %ld"
+                            "  scores %d/%d\n", opt_player, rb.cur.frame, rb_confirmed_frame(&rb),
+                    rb.rollbacks, rb.rollbacks ? (double)rb.resimulated / rb.rollbacks : 0.0,
+                    rb.max_depth, stalls, rb.cur.g[0].score, rb.cur.g[1].score);
+        }
+
+        // sleep until the next frame or datagram, at most a frame
+        long wait = opt_frame_ms * 1000L;
+        if (t0) wait -= (now_us() - t0) % (opt_frame_ms * 1000L);
+        if (next_dg >= 0 && next_dg < wait) wait = next_dg;
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        poll(&pfd, 1, (int)((wait + 999) / 1000));
+    }
+
+    rb_sync(&rb);
+    printf("P%d frames %u  rollbacks %ld (avg %.1f frames, max %ld, avg %.1f us, max %.1f us)"
+           "  stalls %ld\n   datagrams sent %ld dropped %ld  checks %ld desyncs %ld\n"
+           "   scores %d/%d  lines %d/%d  final checksum %016llx\n",
+           opt_player, rb.cur.frame, rb.rollbacks,
+           rb.rollbacks ? (double)rb.resimulated / rb.rollbacks : 0.0, rb.max_depth,
+           rb.rollbacks ? rollback_ns / 1e3 / rb.rollbacks : 0.0, rollback_max_ns / 1e3,
+           stalls, sent, dropped, checks, desyncs,
+           rb.cur.g[0].score, rb.cur.g[1].score, rb.cur.g[0].lines_total, rb.cur.g[1].lines_total,
+           (unsigned long long)rb_match_checksum(&rb.cur, 2));
+    return desyncs != 0;
+}
@@ -4,10 +4,12 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <time.h>
-#include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <sys/types.h>
-// #include "vga.h"
+#include "hal.h"
+#include "rng.h"
+#include "speed.h"
 
 /* Written by Konrad Rosenberg 2025 */
 
@@ -16,45 +18,148 @@
 // BEGIN VGA
 
 #include "font.h"
-#define SCREEN_W 320
-#define SCREEN_H 240
-
-volatile int *VGA = (volatile int*) 0x08000000;
-volatile int *VGA_CTRL = (volatile int*) 0x04000100;
-volatile int *VGA_BUFFER = (volatile int*) 0x04000104;
+#define SCREEN_W HAL_VGA_W
+#define SCREEN_H HAL_VGA_H
 
 struct vector2 {
  int x;
  int y;
 };
 
+// Everything is drawn into this RAM back buffer. vga_push() copies the
+// changed spans into the hidden VGA page and swaps pages on vertical sync.
+static uint8_t backbuf[SCREEN_H][SCREEN_W] __attribute__((aligned(4)));
+
+// changed span [x0, x1) per row for the current and the previous frame;
+// x1 == 0 means the row is clean. The hidden page is two frames behind
+// the back buffer, so vga_push() copies the union of both.
+static short dirty_x0[2][SCREEN_H], dirty_x1[2][SCREEN_H];
+static int dirty_cur = 0;
+static int vga_page = 0;           // page currently on screen
+
+static void mark_dirty(int x, int y, int w) {
+    short *x0 = &dirty_x0[dirty_cur][y], *x1 = &dirty_x1[dirty_cur][y];
+    if (*x1 == 0) { *x0 = x; *x1 = x + w; return; }
+    if (x < *x0) *x0 = x;
+    if (x + w > *x1) *x1 = x + w;
+}
+
+// fill n bytes with color using aligned 32-bit stores for the middle part
+static void fill_span(uint8_t *dst, int n, uint8_t color) {
+    uint32_t word = color * 0x01010101u;
+    while (n > 0 && ((uintptr_t)dst & 3)) { *dst++ = color; n--; }
+    uint32_t *dw = (uint32_t *)dst;
+    for (; n >= 4; n -= 4) *dw++ = word;
+    dst = (uint8_t *)dw;
+    while (n-- > 0) *dst++ = color;
+}
+
+// src and dst share their offset mod 4 (page bases aligned, SCREEN_W % 4 == 0)
+static void copy_span_to_vga(volatile uint8_t *dst, const uint8_t *src, int n) {
+    while (n > 0 && ((uintptr_t)src & 3)) { *dst++ = *src++; n--; }
+    volatile uint32_t *dw = (volatile uint32_t *)dst;
+    const uint32_t *sw = (const uint32_t *)src;
+    for (; n >= 4; n -= 4) *dw++ = *sw++;
+    dst = (volatile uint8_t *)dw;
+    src = (const uint8_t *)sw;
+    while (n-- > 0) *dst++ = *src++;
+}
+
+void fill_rect(int x, int y, int w, int h, char color) {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > SCREEN_W) w = SCREEN_W - x;
+    if (y + h > SCREEN_H) h = SCREEN_H - y;
+    if (w <= 0 || h <= 0) return;
+    for (int row = y; row < y + h; row++) {
+        fill_span(&backbuf[row][x], w, (uint8_t)color);
+        mark_dirty(x, row, w);
+    }
+}
 
 void vga_push(void) {
-    VGA_CTRL[1] = (uint32_t)VGA_BUFFER; // pekar ut vår framebuffer
-    VGA_CTRL[0] = 0; // “kicka igång” visningen
+    while (hal_vga_swap_pending()) {} // previous swap still waiting for vsync
+
+    int hidden = vga_page ^ 1;
+    int prev = dirty_cur ^ 1;
+    volatile uint8_t *page = hal_vga_page(hidden);
+
+    for (int y = 0; y < SCREEN_H; y++) {
+        int x0 = SCREEN_W, x1 = 0;
+        for (int f = 0; f < 2; f++)
+            if (dirty_x1[f][y]) {
+                if (dirty_x0[f][y] < x0) x0 = dirty_x0[f][y];
+                if (dirty_x1[f][y] > x1) x1 = dirty_x1[f][y];
+            }
+        if (x0 < x1) copy_span_to_vga(page + y * SCREEN_W + x0, &backbuf[y][x0], x1 - x0);
+        dirty_x1[prev][y] = 0;  // the older frame is now on both pages
+    }
+    dirty_cur = prev;
+
+    hal_vga_swap(page); // pekar ut vår framebuffer och “kickar igång” visningen
+    vga_page = hidden;
 
     __asm__ volatile ("" ::: "memory");
 }
 
 void set_pixel(int x, int y, char color){
- 
-  volatile char *pixel = (volatile char *)((uintptr_t)0x08000000 + (y * SCREEN_W) + x);
-  *pixel = color;
-  return;
+  if ((unsigned)x >= SCREEN_W || (unsigned)y >= SCREEN_H) return;
+  backbuf[y][x] = color;
+  mark_dirty(x, y, 1);
 }
 
+// 0 after the framebuffer was wiped: draw() must repaint everything once
+static int screen_valid = 0;
+
 void set_all_pixels(char color){
-    for(int x = 0; x < SCREEN_W; x++){
-        for(int y = 0; y < SCREEN_H; y++){
-            set_pixel(x, y, color);
-        }
+    fill_rect(0, 0, SCREEN_W, SCREEN_H, color);
+    screen_valid = 0;
+}
+
+
+// Glyphs pre-expanded to one byte per pixel for the current colours, so a
+// glyph row is a straight copy into the back buffer. Rebuilt only when
+// draw_string() is called with a different foreground/background pair.
+#define GLYPH_COUNT 95
+#define GLYPH_PX_W  (FONT_W + 1)      // draw_string paints columns 0..FONT_W
+
+static uint8_t glyph_px[GLYPH_COUNT][FONT_H][GLYPH_PX_W];
+static int glyph_fg = -1, glyph_bg = -1;
+
+static void glyph_cache_build(char foreground, char background) {
+  for (int g = 0; g < GLYPH_COUNT; g++)
+    for (int i = 0; i < FONT_H; i++) {
+      unsigned int row_hex = font_shapes[g][i];
+      for (int j = 0; j < GLYPH_PX_W; j++) {
+        glyph_px[g][i][j] = (row_hex & 0x1) ? foreground : background;
+        row_hex = row_hex >> 1;
+      }
     }
+  glyph_fg = (uint8_t)foreground;
+  glyph_bg = (uint8_t)background;
 }
 
+static void blit_glyph(int g, int x, int y) {
+  if (x < 0 || y < 0 || x + GLYPH_PX_W > SCREEN_W || y + FONT_H > SCREEN_H) {
+    for (int i = 0; i < FONT_H; i++)          // partly off screen: clip per pixel
+      for (int j = 0; j < GLYPH_PX_W; j++)
+        set_pixel(x + j, y + i, glyph_px[g][i][j]);
+    return;
+  }
+  for (int i = 0; i < FONT_H; i++) {
+    const uint8_t *src = glyph_px[g][i];
+    uint8_t *dst = &backbuf[y + i][x];
+    for (int j = 0; j < GLYPH_PX_W; j++) dst[j] = src[j];
+    mark_dirty(x, y + i, GLYPH_PX_W);
+  }
+}
 
 struct vector2 draw_string(char* string, int start_x, int start_y, char foreground, char background) {
   int cur_x = start_x;
   int cur_y = start_y;
+
+  if (glyph_fg != (uint8_t)foreground || glyph_bg != (uint8_t)background)
+    glyph_cache_build(foreground, background);
  
   while (*string != 0) {
     if (*string == 10) { // new line terminator
@@ -64,18 +169,9 @@ struct vector2 draw_string(char* string, int start_x, int start_y, char foregrou
       cur_x = start_x;
     }
     else {
-      unsigned char *cur_shape = font_shapes[*string - 32];
-      for (int i = 0; i < FONT_H; i++) {
-        unsigned int row_hex = cur_shape[i];
-        for (int j = 0; j <= FONT_W; j++) {
-          if (row_hex & 0x1)
-            set_pixel(cur_x + j, cur_y + i, foreground);
-          else {
-            set_pixel(cur_x + j, cur_y + i, background);
-          }
-          row_hex = row_hex >> 1;
-        }
-      }
+      int g = (unsigned char)*string - 32;
+      if (g < 0 || g >= GLYPH_COUNT) g = '?' - 32; // not in the font
+      blit_glyph(g, cur_x, cur_y);
       cur_x += FONT_W + SPACING_W;
     }
     string++;
@@ -98,13 +194,11 @@ enum {
     KEY_SPACE,
     KEY_ARROW_LEFT,
     KEY_ARROW_RIGHT,
-    KEY_ESC
+    KEY_ESC,
+    KEY_HARD_DROP
 };
 
 
-void handle_interrupt(unsigned cause)
-{}
-
 // top-left of the active piece's 4x4 frame; -1 = none
 static int ax = -1, ay = -1;
 
@@ -141,18 +235,23 @@ void int2asc(int num, char *buffer) {
 }
 
 // ============================= TIMING ============================
-long clockms = 0;
+volatile long clockms = 0; // advanced only by the timer interrupt
 
-volatile unsigned int *status  = (volatile unsigned int*)0x04000020;
-volatile unsigned int *control = (volatile unsigned int*)0x04000024;
-volatile unsigned int *periodl = (volatile unsigned int*)0x04000028;
-volatile unsigned int *periodh = (volatile unsigned int*)0x0400002C;
+static void input_sample(void); // RAW INPUT
+
+void handle_interrupt(unsigned cause)
+{
+    if (cause == HAL_IRQ_TIMER) {
+        hal_timer_ack(); // clear timeout
+        clockms++;
+        input_sample();
+    }
+}
 
 void timeinit() {
-    int period = 3000; // 1 millisecond period
-    *periodl = period & 0xffff;
-    *periodh = (period >> 16) & 0xFFFF;
-    *control = 0x6;
+    int period = HAL_CPU_HZ / 1000 - 1; // 1 millisecond period (counts period..0)
+    hal_timer_init(period, 1);
+    hal_irq_enable();
 }
 
 // ============================= BOARD/STATE =======================
@@ -169,10 +268,21 @@ static int score = 0;
 
 static int level = 0, lines_total = 0;
 static int fall_interval_ms = 1000;
+static int fall_rows = 1;          // gravity: fall_rows rows per fall_interval_ms
+static long fall_acc = 0;          // ms * rows not yet due as a row
+static long gravity_last_ms = 0;   // clockms gravity has caught up to
+#define GRAVITY_TICK_MS 10         // how often gravity catches up; the rate is fall_rows/fall_interval_ms
 static long lock_timer_ms = 0;
+static int lock_delay_ms = 50;
+static int next_level_lines = 10;  // lines_total at which level goes up
+static int col_height[W];          // skyline, see drop_distance()
+static int ghost_drop = -1;        // rows the active piece can still fall, -1 = none
+static uint16_t ghost_rows[H];     // ghost cells, bit c = column c
 
 static int opt_start_level = 0;       // Options menu
 static int opt_soft_drop_enabled = 0; // Options menu
+static int opt_bag_randomizer = 0;    // 0 uniform, 1 bag of all 7
+static int opt_speed_curve = SPEED_10X20; // see speed.h
 
 // board
 static char board[H][W];
@@ -195,63 +305,147 @@ static int has_active_piece(void) {
 int input_limit_ms = 100;
 
 int get_sw(void) {
-  volatile unsigned int *switches = (volatile unsigned int*)0x04000010;
-  return *switches & 0x3ff; // 0011 1111 1111
+  return hal_switches();
 }
 
 int get_btn(void) {
-  volatile unsigned int *button = (volatile unsigned int*)0x040000d0;
-  return *button & 0x1;
-}
-
-int poll_key(void) {
-    volatile unsigned int switches = get_sw();
-    volatile static int prev_switch;
-
-    int key = 0;
-
-    char buffer[100];
+  return hal_button();
+}
+
+// Switches and button are sampled once per timer tick from the interrupt.
+// A level counts as changed only after it has been stable for DEBOUNCE_MS
+// samples; every debounced switch flip is pushed as a key into keyq, which
+// the main loop drains with poll_key(). The ISR is the only producer and
+// the main loop the only consumer, so head/tail need no lock.
+#define DEBOUNCE_MS  5
+#define BTN_BIT      10              // button level next to the 10 switches
+#define KEYQ_SIZE    16              // power of two
+
+static volatile unsigned input_levels;          // debounced, bit BTN_BIT = button
+static unsigned char settle_ms[BTN_BIT + 1];    // how long raw != debounced
+
+static volatile unsigned char keyq[KEYQ_SIZE];
+static volatile unsigned keyq_head, keyq_tail;  // consumer / producer, free-running
+static volatile unsigned keyq_dropped;
+
+static const struct { unsigned mask; int key; } switch_keys[] = {
+    { 0x001, KEY_RIGHT_MOVE },   // SW0
+    { 0x002, KEY_LEFT_MOVE },    // SW1
+    { 0x004, KEY_ROTATE },       // SW2
+    { 0x008, KEY_HARD_DROP },    // SW3
+    { 0x200, KEY_ESC },          // SW9
+};
 
-    int2asc(switches, buffer);
-    draw_string(buffer, 200, 150, 255, 0);
-
-    if ((switches & 0x1) != (prev_switch & 0x1)) {
-        key = KEY_RIGHT_MOVE;
-    } else if ((switches & 0x2) != (prev_switch & 0x2))  {
-        key = KEY_LEFT_MOVE;
-    } else if ((switches & 0x4) != (prev_switch & 0x4))  {
-        key = KEY_ROTATE;
-    } else if ((switches & 0x512) != (prev_switch & 0x512))  {
-        key = KEY_ESC;
+static void keyq_push(int key) {
+    unsigned tail = keyq_tail;
+    if (tail - keyq_head == KEYQ_SIZE) { keyq_dropped++; return; }
+    keyq[tail & (KEYQ_SIZE - 1)] = key;
+    __asm__ volatile ("" ::: "memory");  // slot written before it is published
+    keyq_tail = tail + 1;
+}
+
+// called from the timer interrupt, once per millisecond
+static void input_sample(void) {
+    unsigned raw = get_sw() | get_btn() << BTN_BIT;
+    unsigned levels = input_levels, edges = 0;
+
+    for (int i = 0; i <= BTN_BIT; i++) {
+        unsigned bit = 1u << i;
+        if (!((raw ^ levels) & bit)) { settle_ms[i] = 0; continue; }
+        if (++settle_ms[i] >= DEBOUNCE_MS) {
+            settle_ms[i] = 0;
+            levels ^= bit;
+            edges |= bit;
+        }
     }
+    input_levels = levels;
 
-    prev_switch = switches;
-    return key;
+    for (unsigned i = 0; i < sizeof switch_keys / sizeof switch_keys[0]; i++)
+        if (edges & switch_keys[i].mask) keyq_push(switch_keys[i].key);
 }
 
-// ============================= RNG ===============================
+int poll_key(void) {
+    unsigned head = keyq_head;
+    if (head == keyq_tail) return NO_KEY;
+    int key = keyq[head & (KEYQ_SIZE - 1)];
+    __asm__ volatile ("" ::: "memory");  // slot read before it is released
+    keyq_head = head + 1;
+    return key;
+}
 
-static int seed;
+static int switches_down(void) { return input_levels & 0x3ff; }
+static int button_down(void)   { return (input_levels >> BTN_BIT) & 0x1; }
 
-void snrand(unsigned int s) {
-    seed = s;
-}
+// ============================= RNG ===============================
+// counter-based (rng.h): the board and the host build deal the same pieces
+// for the same seed, and each game gets its own stream split off the seed
+static Rng seed_rng;
+static Rng spawn_rng;                              // spawn columns
+static PieceQueue pieces;                          // upcoming shapes
+static unsigned games_started = 0;
 
-unsigned int nrand(void) {
-    // pseudo-random algorithm from sources online
-    seed = seed * 1103515245 + 12345;
-    return (seed / 65536) % 32768;
+static void new_game_streams(void) {
+    Rng game = rng_split(&seed_rng, games_started++);
+    pieces_init(&pieces, rng_split(&game, 0), 7, opt_bag_randomizer ? PIECES_BAG : PIECES_UNIFORM);
+    spawn_rng = rng_split(&game, 1);
 }
 
 static unsigned int get_seed(void) {               // read seed once
     draw_string("Set a seed on the switches and press button to continue!: ", 15, 90, 255, 0);
-    
+    vga_push();
+
     while (!get_btn()) {}
 
     return get_sw();
 }
 
 
+// ============================ Skyline ============================
+// col_height[c] = rows from the floor up to the top settled cell of column
+// c, kept current by lock_piece(). The landing row then follows from the
+// piece's lowest cell per column, without stepping the piece down row by row.
+static void skyline_add(int r, int c) { if (col_height[c] < H - r) col_height[c] = H - r; }
+
+// every cleared row was full, so it lay under each column's top; lower the
+// tops by that much and walk down past holes that became the top
+static void skyline_after_clear(int cleared) {
+    for (int c = 0; c < W; ++c) {
+        int h = col_height[c] - cleared;
+        while (h > 0 && board[H - h][c] != 2) --h;
+        col_height[c] = h;
+    }
+}
+
+// rows the active cells can fall before they rest, -1 if there are none
+static int drop_distance(void) {
+    int bottom[W];                              // lowest active row per column
+    for (int c = 0; c < W; ++c) bottom[c] = -1;
+    for (int r = 0; r < H; ++r)
+        for (int c = 0; c < W; ++c)
+            if (board[r][c] == 1) bottom[c] = r;
+
+    int drop = -1;
+    for (int c = 0; c < W; ++c) {
+        if (bottom[c] < 0) continue;
+        int r = bottom[c] + 1, top = H - col_height[c];
+        if (r <= top) r = top;                            // above the skyline
+        else while (r < H && board[r][c] != 2) ++r;       // tucked under an overhang
+        if (drop < 0 || r - 1 - bottom[c] < drop) drop = r - 1 - bottom[c];
+    }
+    return drop;
+}
+
+// only needed when the piece moves sideways or rotates; falling keeps the
+// landing spot, so ghost_rows stays put and only ghost_drop counts down
+static void update_ghost(void) {
+    for (int r = 0; r < H; ++r) ghost_rows[r] = 0;
+    ghost_drop = drop_distance();
+    if (ghost_drop < 0) return;
+    for (int r = 0; r + ghost_drop < H; ++r)
+        for (int c = 0; c < W; ++c)
+            if (board[r][c] == 1) ghost_rows[r + ghost_drop] |= (uint16_t)(1u << c);
+}
+
 // ========== Active-block bounds + rotation helpers (4x4 box) ==========
 typedef struct { int x0, y0, x1, y1, found; } AABB;
 static void extract_active_frame_4(char out[4][4]) {
@@ -330,6 +524,7 @@ static void rotate_active_block(int dir) {
                     if (board[r][c] == 1) board[r][c] = 0;
             write_frame_4(rot, nfx, nfy);
             ax = nfx; ay = nfy;   // update frame if we kicked
+            update_ghost();
             return;
         }
     }
@@ -361,6 +556,7 @@ static void move_piece_horiz(int dx) {
                 if (board[r][c] == 1) { board[r][c-1] = 1; board[r][c] = 0; }
     }
     if (ax != -1) ax += dx;  // keep frame in sync
+    update_ghost();
 }
 
 static int can_piece_fall(void) {
@@ -376,12 +572,15 @@ static int can_piece_fall(void) {
             }
     return 1;
 }
-static void move_piece_down(void) {
+static void move_piece_down_by(int n) {
+    if (n <= 0) return;                            // resting: a zero move would erase the piece
     for (int r = H-1; r >= 0; r--)
         for (int c = 0; c < W; c++)
-            if (board[r][c] == 1) { board[r+1][c] = 1; board[r][c] = 0; }
-    if (ay != -1) ay += 1;    // keep frame in sync
+            if (board[r][c] == 1) { board[r+n][c] = 1; board[r][c] = 0; }
+    if (ay != -1) ay += n;    // keep frame in sync
+    if (ghost_drop >= n) ghost_drop -= n;
 }
+static void move_piece_down(void) { move_piece_down_by(1); }
 
 // =============== Line clear + collapse + scoring/level ===========
 static int clear_full_lines_and_collapse(void) {
@@ -400,6 +599,13 @@ static int clear_full_lines_and_collapse(void) {
     }
     return cleared;
 }
+// gravity and lock delay of the current level: a table load, no floating point
+static void load_speed(void) {
+    const SpeedLevel *s = speed_level(opt_speed_curve, level);
+    fall_rows = s->rows;
+    fall_interval_ms = s->per_ms;
+    lock_delay_ms = s->lock_ms;
+}
 static void apply_scoring_and_level(int lines_cleared) {
     if (lines_cleared == 1) score += 100;
     else if (lines_cleared == 2) score += 300;
@@ -407,20 +613,28 @@ static void apply_scoring_and_level(int lines_cleared) {
     else if (lines_cleared >= 4) score += 800;
 
     lines_total += lines_cleared;
-    level = lines_total / 10;
-    double ms = 1000.0 * 0.90 * (double)level; //double ms = 1000.0 * pow(0.90, (double)level);
-    if (ms < 80.0) ms = 80.0;
-    fall_interval_ms = (int)ms;
+    while (lines_total >= next_level_lines) {
+        level++;
+        next_level_lines = speed_next_level_lines(opt_speed_curve, opt_start_level, level);
+        load_speed();
+    }
 }
 static void lock_piece(void) {
     for (int r = 0; r < H; r++)
         for (int c = 0; c < W; c++)
-            if (board[r][c] == 1) board[r][c] = 2;
+            if (board[r][c] == 1) { board[r][c] = 2; skyline_add(r, c); }
     int lines = clear_full_lines_and_collapse();
+    if (lines) skyline_after_clear(lines);
     apply_scoring_and_level(lines);
     new_block = 1;
     lock_timer_ms = 0;
     ax = ay = -1;           // clear active 4x4 frame
+    update_ghost();         // no active cells: clears the ghost
+}
+static void hard_drop(void) {                      // one move straight to the ghost
+    if (ghost_drop < 0) return;
+    move_piece_down_by(ghost_drop);
+    lock_piece();
 }
 
 
@@ -445,9 +659,9 @@ static const char SHAPES[7][4][4] = {  // <— was [6], must be [7]
 unsigned int next_block;
 
 static void spawn_random_block(void) {
-    unsigned int spawn_x = nrand() % (W - 3); // ensure room for 4-wide frame
-    unsigned int randshape = next_block;
-    next_block = nrand() % 7;
+    unsigned int spawn_x = rng_below(&spawn_rng, W - 3); // ensure room for 4-wide frame
+    unsigned int randshape = pieces_next(&pieces);
+    next_block = pieces_peek(&pieces, 0);
     const char (*shape)[4] = SHAPES[randshape];
 
     ax = (int)spawn_x;
@@ -466,24 +680,43 @@ static void spawn_random_block(void) {
     for (int r = 0; r < 4; r++)
         for (int c = 0; c < 4; c++)
             if (shape[r][c] == 1) board[ay + r][ax + c] = 1;
+    update_ghost();
 
     // (Optional) remove this test line fill from reset:
     // for (int i = 0; i < 10; i++) { board[18][i] = 1; }
 }
 
 // ========================= Gravity (time-based) ==================
-static void gravity_step() {
-    if (!has_active_piece()) return;
-    if (can_piece_fall()) {
-        move_piece_down();
-//        if (can_piece_fall()) lock_timer_ms = 0; // still airborne afterwards
-    } else {
-        lock_timer_ms += fall_interval_ms;
-        if (lock_timer_ms >= 50) { // LOCK_TIMER_MS
-            lock_piece();
-            return;
-        }
+// One step covers any dt: it works out how many rows came due, moves the
+// piece at most ghost_drop rows in one go and counts the time spent resting
+// on the stack towards the lock delay. rows is fall_rows, times 11 while the
+// button is held (soft drop). Returns the part of dt_ms left over after the
+// piece locked, 0 otherwise.
+static long gravity_step(long dt_ms, int rows) {
+    if (ghost_drop < 0) return 0;                   // no active piece
+
+    long acc = fall_acc + dt_ms * rows;
+    long due = acc / fall_interval_ms;
+    long rest_ms = dt_ms;
+
+    if (due < ghost_drop) {
+        fall_acc = acc % fall_interval_ms;
+        if (due) { move_piece_down_by((int)due); lock_timer_ms = 0; } // still airborne afterwards
+        return 0;
     }
+    if (ghost_drop > 0) {
+        // the landing row came due once fall_acc + t * rows reached ghost_drop * interval
+        long t = ((long)ghost_drop * fall_interval_ms - fall_acc + rows - 1) / rows;
+        rest_ms = dt_ms - t;
+        move_piece_down_by(ghost_drop);
+        lock_timer_ms = 0;
+    }
+    fall_acc = acc % fall_interval_ms;              // rows owed while resting are dropped
+    lock_timer_ms += rest_ms;
+    if (lock_timer_ms < lock_delay_ms) return 0;
+    long left = lock_timer_ms - lock_delay_ms;
+    lock_piece();
+    return left;
 }
 
 // ======================= Menu / Options helpers ==================
@@ -510,71 +743,195 @@ static void reset_game_with_options(void) {
     score = 0;
     lines_total = 0;
     level = opt_start_level;
-
-    double ms = 1000.0 * 0.90 * (double)level; // double ms = 1000.0 * pow(0.90, (double)level);
-    if (ms < 80.0) ms = 80.0;
-    fall_interval_ms = (int)ms;
+    next_level_lines = speed_next_level_lines(opt_speed_curve, opt_start_level, level);
+    load_speed();
 
     lock_timer_ms = 0;
+    fall_acc = 0;
+    for (int c = 0; c < W; ++c) col_height[c] = 0;
     new_block = 1;
-    next_block = nrand() % 7;
+    new_game_streams();
+    next_block = pieces_peek(&pieces, 0);
 
     for (int i = 0; i < 10; i++) {
         board[18][i] = 1;
     }
+    update_ghost();         // the test line above falls like a piece
+    gravity_last_ms = clockms;
 }
 
 static void draw_block(int x, int y, int type) {
-    char colors[] = {1, 50, 150};
+    char colors[] = {1, 50, 150, 0x49};   // empty, active, settled, ghost
     int box_x = 50; // these define the absolute position of the top left corner
     int box_y = 50;
 
     int size_xy = 8;
 
-    for (int i = 0; i < size_xy; i++)
-        for (int j = 0; j < size_xy; j++)
-            set_pixel(box_x + (x * size_xy + i), box_y + (y * size_xy + j), colors[type]);
+    fill_rect(box_x + x * size_xy, box_y + y * size_xy, size_xy, size_xy, colors[type]);
 }
 
 static int refresh_rate_ms = 20;
 
-static void draw(void) {
-    set_all_pixels(0);
-    struct vector2 last_pos;
-
+// ======================= Dirty tracking ==========================
+// draw() only repaints board cells and HUD values that differ from what is
+// already on screen; a frame where just the piece moved touches ~8 cells.
+static char shown[H][W];           // board cells as last painted
+
+typedef struct {
+    struct vector2 pos;            // where the value text starts
+    int value;                     // last painted value, -1 = unknown
+    int width;                     // length of the last painted text
+} HudField;
+
+static HudField hud_score, hud_level, hud_fall, hud_next, hud_switch;
+
+// repaint a HUD value, blanking any leftover characters of a longer old text
+static void draw_hud_text(HudField *f, const char *text) {
+    char buffer[32];
+    int n = 0;
+    while (text[n] && n < 31) { buffer[n] = text[n]; n++; }
+    int len = n;
+    while (n < f->width && n < 31) buffer[n++] = ' ';
+    buffer[n] = '\0';
+    draw_string(buffer, f->pos.x, f->pos.y, 255, 0);
+    f->width = len;
+}
+
+static void draw_hud_number(HudField *f, int value) {
+    if (f->value == value) return;
     char buffer[100];
-    int2asc(score, buffer);
+    int2asc(value, buffer);
+    draw_hud_text(f, buffer);
+    f->value = value;
+}
 
-    last_pos = draw_string("Score: ", 200, 40, 255, 0);
-    draw_string(buffer, last_pos.x, last_pos.y, 255, 0);
+static void draw_hud_labels(void) {
+    hud_score.pos = draw_string("Score: ", 200, 40, 255, 0);
+    hud_level.pos = draw_string("Level: ", 200, 80, 255, 0);
+    // "Fall" and "NEXT" each sit one text line below the previous label
+    hud_fall.pos  = draw_string("Fall (ms): ", 200, hud_level.pos.y + FONT_H + SPACING_H, 255, 0);
+    hud_next.pos  = draw_string("NEXT: ", 200, hud_fall.pos.y + FONT_H + SPACING_H, 255, 0);
 
-    last_pos = draw_string("Level: ", 200, 80, 255, 0);
-    int2asc(level, buffer);
-    last_pos = draw_string(buffer, last_pos.x, last_pos.y, 255, 0);
+    hud_switch.pos.x = 200;       // raw switch value, no label
+    hud_switch.pos.y = 150;
 
-    last_pos = draw_string("\nFall (ms): ", 200, last_pos.y, 255, 0);
-    int2asc(fall_interval_ms, buffer);
-    last_pos = draw_string(buffer, last_pos.x, last_pos.y, 255, 0);
+    hud_score.value = hud_level.value = hud_fall.value = hud_next.value = hud_switch.value = -1;
+    hud_score.width = hud_level.width = hud_fall.width = hud_next.width = hud_switch.width = 0;
+}
 
-    last_pos = draw_string("\nNEXT: ", 200, last_pos.y, 255, 0);
-    last_pos = draw_string(SHAPE_NAMES[next_block], last_pos.x, last_pos.y, 255, 0);
-    
-    // draw blocks
+static void draw(void) {
+    if (!screen_valid) {
+        draw_hud_labels();
+        for (int i = 0; i < H; i++)
+            for (int j = 0; j < W; j++) shown[i][j] = -1;
+        screen_valid = 1;
+    }
+
+    draw_hud_number(&hud_score, score);
+    draw_hud_number(&hud_level, level);
+    draw_hud_number(&hud_fall, fall_interval_ms);
+    draw_hud_number(&hud_switch, switches_down());
+    if (hud_next.value != (int)next_block) {
+        draw_hud_text(&hud_next, SHAPE_NAMES[next_block]);
+        hud_next.value = next_block;
+    }
+
+    // draw only the blocks that changed since the last frame
     for (int i = 0; i < H; i++) {
-        for (int j = 0; j < W; j++) draw_block(j, i, board[i][j]);
+        for (int j = 0; j < W; j++) {
+            char cell = board[i][j];
+            if (!cell && (ghost_rows[i] >> j & 1)) cell = 3;
+            if (cell == shown[i][j]) continue;
+            draw_block(j, i, cell);
+            shown[i][j] = cell;
+        }
     }
 
 }
 
+// ============================= Scheduler =========================
+// Tasks run from the main loop once clockms reaches their deadline. A run
+// returns the delay to its next deadline, which is added to the previous
+// deadline rather than to "now", so gravity never drifts or skips a tick
+// when a frame takes long; it just catches up on the next pass.
+typedef struct {
+    int (*run)(void);   // returns ms until the next run
+    long due_ms;
+    int skip_late;      // drop missed runs instead of catching up (rendering)
+} Task;
+
+static int input_task(void) {
+    int key = poll_key();
+    if (key == KEY_LEFT_MOVE) {
+        move_piece_horiz(-1);
+    } else if (key == KEY_RIGHT_MOVE) {
+        move_piece_horiz(+1);
+    } else if (key == KEY_ROTATE) {
+        rotate_active_block(+1);
+    } else if (key == KEY_SPACE && opt_soft_drop_enabled && can_piece_fall()) {
+        move_piece_down();
+    } else if (key == KEY_HARD_DROP) {
+        hard_drop();
+    } else if (key == KEY_ESC) {
+        state = ST_MENU;
+    }
+    return 1;
+}
+
+static int gravity_task(void) {
+    long dt = clockms - gravity_last_ms;
+    gravity_last_ms += dt;
+    do {
+        dt = gravity_step(dt, fall_rows * (1 + button_down() * 10)); // button = soft drop
+        if (!has_active_piece() && new_block) {
+            new_block = 0;
+            spawn_random_block();
+        }
+    } while (dt > 0 && state == ST_PLAYING);
+    return GRAVITY_TICK_MS;
+}
+
+static int render_task(void) {
+    draw();
+    vga_push();
+    return refresh_rate_ms;
+}
+
+static Task tasks[] = {
+    { input_task,   0, 0 },
+    { gravity_task, 0, 0 },
+    { render_task,  0, 1 },
+};
+#define TASK_COUNT (int)(sizeof tasks / sizeof tasks[0])
+
+static void tasks_start(void) {
+    for (int i = 0; i < TASK_COUNT; i++) tasks[i].due_ms = clockms;
+}
+
+// run every task whose deadline has passed; 0 if none was due
+static int run_due_tasks(void) {
+    int ran = 0;
+    for (int i = 0; i < TASK_COUNT && state == ST_PLAYING; i++) {
+        Task *t = &tasks[i];
+        if (clockms - t->due_ms < 0) continue;
+        int delay = t->run();
+        t->due_ms += delay;
+        if (t->skip_late && clockms - t->due_ms >= 0) t->due_ms = clockms + delay;
+        ran = 1;
+    }
+    return ran;
+}
+
 // ================================ MAIN ===========================
 int main() {
+    hal_init();
     vga_push();
 
     char background = 0;
     set_all_pixels(background);
 
     unsigned int s = get_seed();
-    snrand(s ? s : 1);
+    rng_init(&seed_rng, s, 0);
 
     long prev_input = 0;
 
@@ -589,6 +946,7 @@ int main() {
                     reset_game_with_options();
                     state = ST_PLAYING;
                     set_all_pixels(background);
+                    tasks_start();
                     break;
 
                     int key = poll_key();
@@ -597,6 +955,7 @@ int main() {
                         reset_game_with_options();
                         state = ST_PLAYING;
                         set_all_pixels(background);
+                        tasks_start();
                         break;
                     } else if (key == 'o' || key == 'O') {
                         state = ST_OPTIONS;
@@ -612,10 +971,12 @@ int main() {
 
             case ST_OPTIONS: {
                 draw_options(opt_start_level, opt_soft_drop_enabled);
+                vga_push();
                 while (true) {
                 //    if (clockms - prev_input >= input_limit_ms) {
                         prev_input = clockms;
                         int key = poll_key();
+                        if (!key) { hal_wait_for_interrupt(); continue; } // keys arrive from the timer tick
                         if (key == KEY_ARROW_LEFT && opt_start_level > 0)  opt_start_level--;
                         if (key == KEY_ARROW_RIGHT && opt_start_level < 20) opt_start_level++;
                     //  if (key == 's' || key == 'S') opt_soft_drop_enabled ^= 1;
@@ -625,48 +986,14 @@ int main() {
             } break;
 
             case ST_PLAYING: {
-                if ((*status) & 0x1) { // if timeout = 1
-                    *status = 0; // clear timeout
-                    clockms++;
-
-                    if (clockms % (fall_interval_ms / (1 + get_btn() * 10)) == 0) {
-                        gravity_step();
-                        if (!has_active_piece() && new_block) {
-                            new_block = 0;
-                            spawn_random_block();
-                        }
-                    }
-
-                    if (clockms % refresh_rate_ms == 0) {
-                        draw();
-                        vga_push();
-                    }
+                if (!run_due_tasks()) {
+                    hal_wait_for_interrupt(); // idle until the next timer tick
                 }
-
-            //    if (clockms - prev_input >= input_limit_ms) {
-                    int key = poll_key();
-                    if (key == KEY_LEFT_MOVE) {
-                        move_piece_horiz(-1);
-                        prev_input = clockms;
-                    } else if (key == KEY_RIGHT_MOVE) {
-                        move_piece_horiz(+1);
-                        prev_input = clockms;
-                    } else if (key == KEY_ROTATE) {
-                        rotate_active_block(+1);
-                        prev_input = clockms;
-                    } else if (key == KEY_SPACE && opt_soft_drop_enabled && can_piece_fall()) {
-                        move_piece_down();
-                        prev_input = clockms;
-                    } else if (key == KEY_ESC) {
-                        state = ST_MENU;
-                        break;
-                    }
-            //    }
-            
             } break;
 
             default: state = ST_EXIT; break;
         }
     }
+    vga_push(); // show the final frame (game over text)
     return 0;
 }
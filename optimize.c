@@ -0,0 +1,452 @@
+// optimize.c — CMA-ES search for bot weights, scored by playing seeded games
+// build: gcc -O2 -std=c11 -pthread optimize.c engine.c bot.c -o optimize -lm
+// run:   ./optimize -G 100 -g 64 -c tune.ckpt          (run it again to resume)
+//        ./tourney -n 10000 -c old=-0.51,0.76,-0.36,-0.18 -c new=<the weights it prints>
+//
+// The search is over the five weights of BotWeights (height, lines, holes,
+// bumpiness, wells) with CMA-ES: each generation samples -p candidates
+// around a mean from a learned covariance, plays -g games with each, and
+// moves the mean and reshapes the covariance towards the best half. The
+// greedy bot only compares placements, so scaling the weights changes
+// nothing; candidates are played at unit length, and the mean and step
+// size are rescaled together after every update to keep it that way.
+//
+// Common random numbers: within a generation every candidate plays the
+// same seeds (game i is Philox stream gen * g + i of -s, or stream i every
+// generation with -F), so candidates are compared on the same luck. The
+// mean itself is played alongside them each generation, outside the
+// update, to show progress.
+//
+// Games are the unit of work: a pool of -t threads (all cores by default,
+// the main thread included) takes them one at a time from a shared
+// counter, and results go to fixed (candidate, game) slots that are summed
+// in order, so a run is the same whatever the thread count. With -c the
+// whole state is written to a checkpoint after every generation (a
+// temporary file renamed into place); starting with the same -c resumes
+// from it and continues exactly as the uninterrupted run would have.
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "engine.h"
+#include "bot.h"
+
+// ============================= TIMING ============================
+static long now_ms(void) {
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)(ts.tv_sec*1000LL + ts.tv_nsec/1000000LL);
+}
+
+// ============================= OPTIONS ===========================
+#define N 5                          // weights searched
+#define MAX_POP 64
+
+static int opt_threads = 0;          // 0: one per online CPU
+static int opt_pop = 0;              // 0: 4 + 3 ln N
+static int opt_games = 64;           // per candidate per generation
+static int opt_gens = 50;
+static int opt_fixed_seeds = 0;      // -F: the same games every generation
+static int opt_depth = 1;
+static int opt_lines = 0;            // -f lines: fitness is lines, not score
+static double opt_sigma = 0.2;
+static double opt_x0[N] = { -0.51, 0.76, -0.36, -0.18, 0 };
+static Rules opt_rules = RULES_10X20;
+static int opt_level = 0;
+static int opt_bot_ms = 50;
+static long opt_limit_ms = 120000;
+static uint64_t opt_seed = 1;
+static const char *opt_ckpt = NULL;
+
+// ============================= GAMES =============================
+static BotWeights as_weights(const double *x) {
+    BotWeights w = { x[0], x[1], x[2], x[3], x[4] };
+    return w;
+}
+
+typedef struct {
+    double fitness;
+    long pieces;
+} GameResult;
+
+static double *candidates;           // [cand * N], unit length
+static int n_cands;                  // pop + the mean
+static int gen;                      // generation being played
+static GameResult *results;          // [cand * opt_games + game]
+static atomic_long next_job;
+static atomic_int pool_stop;
+static pthread_barrier_t start_line, finish_line;
+
+static void play(int cand, int game, GameResult *r) {
+    Rng rng;
+    rng_init(&rng, opt_seed, (uint64_t)(opt_fixed_seeds ? game : (long)gen * opt_games + game));
+    Game g;
+    game_init(&g, opt_rules, rng, opt_level);
+    Bot b;
+    BotWeights w = as_weights(&candidates[cand * N]);
+    bot_init(&b, &w);
+    b.depth = opt_depth;
+    while (!g.over && g.time_ms < opt_limit_ms) {
+        game_apply(&g, bot_next_action(&b, &g));
+        game_tick(&g, opt_bot_ms);
+    }
+    r->fitness = opt_lines ? g.lines_total : g.score;
+    r->pieces = g.pieces;
+}
+
+// seed-major, so the long games of good candidates spread over the pool
+static void run_jobs(void) {
+    long jobs = (long)n_cands * opt_games;
+    for (long j; (j = atomic_fetch_add(&next_job, 1)) < jobs; ) {
+        int game = (int)(j / n_cands), cand = (int)(j % n_cands);
+        play(cand, game, &results[cand * opt_games + game]);
+    }
+}
+
+static void *pool_thread(void *arg) {
+    (void)arg;
+    for (;;) {
+        pthread_barrier_wait(&start_line);
+        if (atomic_load(&pool_stop)) return NULL;
+        run_jobs();
+        pthread_barrier_wait(&finish_line);
+    }
+}
+
+// play every game of the generation, the main thread included
+static void play_generation(void) {
+    atomic_store(&next_job, 0);
+    pthread_barrier_wait(&start_line);
+    run_jobs();
+    pthread_barrier_wait(&finish_line);
+}
+
+// ============================= CMA-ES ============================
+typedef struct {
+    int gen;
+    long games, pieces;
+    double sigma;
+    double m[N], ps[N], pc[N], C[N][N];
+    double best_f, best[N];          // best mean seen, by its own games
+} Cma;
+
+static int lambda, mu;
+static double wt[MAX_POP], mueff, cc, cs, c1, cmu, damps, chi_n;
+
+static void cma_params(void) {
+    lambda = opt_pop ? opt_pop : 4 + (int)(3 * log(N));
+    mu = lambda / 2;
+    double sum = 0, sq = 0;
+    for (int i = 0; i < mu; ++i) { wt[i] = log(mu + 0.5) - log(i + 1.0); sum += wt[i]; }
+    for (int i = 0; i < mu; ++i) { wt[i] /= sum; sq += wt[i] * wt[i]; }
+    mueff = 1 / sq;
+    cc = (4 + mueff / N) / (N + 4 + 2 * mueff / N);
+    cs = (mueff + 2) / (N + mueff + 5);
+    c1 = 2 / ((N + 1.3) * (N + 1.3) + mueff);
+    cmu = fmin(1 - c1, 2 * (mueff - 2 + 1 / mueff) / ((N + 2) * (N + 2) + mueff));
+    damps = 1 + 2 * fmax(0, sqrt((mueff - 1) / (N + 1)) - 1) + cs;
+    chi_n = sqrt(N) * (1 - 1.0 / (4 * N) + 1.0 / (21 * N * N));
+}
+
+static double norm(const double *v) {
+    double s = 0;
+    for (int i = 0; i < N; ++i) s += v[i] * v[i];
+    return sqrt(s);
+}
+
+static void cma_init(Cma *c) {
+    memset(c, 0, sizeof *c);
+    double len = norm(opt_x0);
+    for (int i = 0; i < N; ++i) { c->m[i] = opt_x0[i] / len; c->C[i][i] = 1; }
+    c->sigma = opt_sigma;
+    c->best_f = -1;
+}
+
+// C = B diag(d^2) B^T by cyclic Jacobi rotations; B's columns are the axes
+static void eigen(const double C[N][N], double B[N][N], double d[N]) {
+    double a[N][N];
+    memcpy(a, C, sizeof a);
+    for (int i = 0; i < N; ++i) for (int j = 0; j < N; ++j) B[i][j] = i == j;
+    for (int sweep = 0; sweep < 50; ++sweep) {
+        double off = 0;
+        for (int p = 0; p < N; ++p) for (int q = p + 1; q < N; ++q) off += a[p][q] * a[p][q];
+        if (off < 1e-30) break;
+        for (int p = 0; p < N; ++p)
+            for (int q = p + 1; q < N; ++q) {
+                if (fabs(a[p][q]) < 1e-300) continue;
+                double th = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+                double t = (th >= 0 ? 1 : -1) / (fabs(th) + sqrt(th * th + 1));
+                double cs_ = 1 / sqrt(t * t + 1), sn = t * cs_;
+                for (int k = 0; k < N; ++k) {            // a = J^T a J
+                    double akp = a[k][p], akq = a[k][q];
+                    a[k][p] = cs_ * akp - sn * akq;
+                    a[k][q] = sn * akp + cs_ * akq;
+                }
+                for (int k = 0; k < N; ++k) {
+                    double apk = a[p][k], aqk = a[q][k];
+                    a[p][k] = cs_ * apk - sn * aqk;
+                    a[q][k] = sn * apk + cs_ * aqk;
+                }
+                for (int k = 0; k < N; ++k) {
+                    double bkp = B[k][p], bkq = B[k][q];
+                    B[k][p] = cs_ * bkp - sn * bkq;
+                    B[k][q] = sn * bkp + cs_ * bkq;
+                }
+            }
+    }
+    for (int i = 0; i < N; ++i) d[i] = sqrt(fmax(a[i][i], 1e-20));
+}
+
+// standard normal from the generation's own stream (Box-Muller)
+static double gauss(Rng *r) {
+    double u = (rng_u32(r) + 0.5) / 4294967296.0, v = (rng_u32(r) + 0.5) / 4294967296.0;
+    return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+typedef struct { double f; int i; } Ranked;
+
+static int by_fitness(const void *a, const void *b) {     // best first; ties by index
+    const Ranked *x = a, *y = b;
+    if (x->f != y->f) return x->f < y->f ? 1 : -1;
+    return x->i - y->i;
+}
+
+// one generation: sample, play, update; fills f[] with the mean fitnesses
+static void cma_step(Cma *c, double *f, double *mean_f) {
+    double B[N][N], d[N], y[MAX_POP][N];
+    eigen(c->C, B, d);
+    Rng rng;
+    rng_init(&rng, opt_seed ^ 0xC3A5C85C97CB3127ull, (uint64_t)c->gen);
+    for (int k = 0; k < lambda; ++k) {
+        double z[N];
+        for (int i = 0; i < N; ++i) z[i] = gauss(&rng);
+        for (int i = 0; i < N; ++i) {
+            y[k][i] = 0;
+            for (int j = 0; j < N; ++j) y[k][i] += B[i][j] * d[j] * z[j];
+        }
+        double x[N];
+        for (int i = 0; i < N; ++i) x[i] = c->m[i] + c->sigma * y[k][i];
+        double len = norm(x);
+        for (int i = 0; i < N; ++i) candidates[k * N + i] = x[i] / len;
+    }
+    memcpy(&candidates[lambda * N], c->m, sizeof c->m);    // the mean, for the record
+
+    gen = c->gen;
+    play_generation();
+    for (int k = 0; k < n_cands; ++k) {
+        double s = 0;
+        for (int g = 0; g < opt_games; ++g) {
+            s += results[k * opt_games + g].fitness;
+            c->pieces += results[k * opt_games + g].pieces;
+        }
+        f[k] = s / opt_games;
+    }
+    c->games += (long)n_cands * opt_games;
+    *mean_f = f[lambda];
+    if (*mean_f > c->best_f) { c->best_f = *mean_f; memcpy(c->best, c->m, sizeof c->m); }
+
+    Ranked rk[MAX_POP];
+    for (int k = 0; k < lambda; ++k) rk[k] = (Ranked){ f[k], k };
+    qsort(rk, (size_t)lambda, sizeof *rk, by_fitness);
+
+    // the steps are taken as sampled (y), not as played (unit length)
+    double yw[N] = { 0 }, zw[N] = { 0 }, t[N];
+    for (int r = 0; r < mu; ++r)
+        for (int i = 0; i < N; ++i) yw[i] += wt[r] * y[rk[r].i][i];
+    for (int i = 0; i < N; ++i) c->m[i] += c->sigma * yw[i];
+    for (int j = 0; j < N; ++j) {                           // C^-1/2 yw = B D^-1 B^T yw
+        t[j] = 0;
+        for (int i = 0; i < N; ++i) t[j] += B[i][j] * yw[i];
+        t[j] /= d[j];
+    }
+    for (int i = 0; i < N; ++i) for (int j = 0; j < N; ++j) zw[i] += B[i][j] * t[j];
+
+    for (int i = 0; i < N; ++i) c->ps[i] = (1 - cs) * c->ps[i] + sqrt(cs * (2 - cs) * mueff) * zw[i];
+    double ps_len = norm(c->ps);
+    int hsig = ps_len / sqrt(1 - pow(1 - cs, 2.0 * (c->gen + 1))) / chi_n < 1.4 + 2.0 / (N + 1);
+    for (int i = 0; i < N; ++i) c->pc[i] = (1 - cc) * c->pc[i] + hsig * sqrt(cc * (2 - cc) * mueff) * yw[i];
+    for (int i = 0; i < N; ++i)
+        for (int j = 0; j < N; ++j) {
+            double rank_mu = 0;
+            for (int r = 0; r < mu; ++r) rank_mu += wt[r] * y[rk[r].i][i] * y[rk[r].i][j];
+            c->C[i][j] = (1 - c1 - cmu) * c->C[i][j]
+                       + c1 * (c->pc[i] * c->pc[j] + (1 - hsig) * cc * (2 - cc) * c->C[i][j])
+                       + cmu * rank_mu;
+        }
+    c->sigma *= exp(cs / damps * (ps_len / chi_n - 1));
+
+    double len = norm(c->m);                                // back to unit length, step size with it
+    for (int i = 0; i < N; ++i) c->m[i] /= len;
+    c->sigma /= len;
+    c->gen++;
+}
+
+// ============================= CHECKPOINT ========================
+// text, with every double to 17 digits so a resumed run is bit-for-bit
+// the run that was interrupted
+static void put_vec(FILE *f, const char *name, const double *v) {
+    fprintf(f, "%s", name);
+    for (int i = 0; i < N; ++i) fprintf(f, " %.17g", v[i]);
+    fprintf(f, "\n");
+}
+
+static int get_vec(FILE *f, const char *name, double *v) {
+    char got[16];
+    if (fscanf(f, "%15s", got) != 1 || strcmp(got, name) != 0) return 0;
+    for (int i = 0; i < N; ++i) if (fscanf(f, "%lf", &v[i]) != 1) return 0;
+    return 1;
+}
+
+// everything a run's results depend on besides the state
+static void run_key(char *buf, size_t len) {
+    snprintf(buf, len, "n=%d pop=%d games=%d fixed=%d depth=%d fitness=%s rules=%d level=%d bot_ms=%d limit_ms=%ld seed=%llu",
+             N, lambda, opt_games, opt_fixed_seeds, opt_depth, opt_lines ? "lines" : "score", (int)opt_rules,
+             opt_level, opt_bot_ms, opt_limit_ms, (unsigned long long)opt_seed);
+}
+
+static int ckpt_write(const char *path, const Cma *c) {
+    char tmp[4096], key[256];
+    if (snprintf(tmp, sizeof tmp, "%s.tmp", path) >= (int)sizeof tmp) { errno = ENAMETOOLONG; return -1; }
+    FILE *f = fopen(tmp, "w");
+    if (!f) return -1;
+    run_key(key, sizeof key);
+    fprintf(f, "tetris-cma 1\n%s\n", key);
+    fprintf(f, "gen %d games %ld pieces %ld\n", c->gen, c->games, c->pieces);
+    fprintf(f, "sigma %.17g\n", c->sigma);
+    put_vec(f, "mean", c->m);
+    put_vec(f, "ps", c->ps);
+    put_vec(f, "pc", c->pc);
+    for (int i = 0; i < N; ++i) put_vec(f, "C", c->C[i]);
+    fprintf(f, "best_f %.17g\n", c->best_f);
+    put_vec(f, "best", c->best);
+    if (fflush(f) != 0 || fsync(fileno(f)) < 0) { int e = errno; fclose(f); unlink(tmp); errno = e; return -1; }
+    if (fclose(f) != 0) { int e = errno; unlink(tmp); errno = e; return -1; }
+    return rename(tmp, path);
+}
+
+// 1 resumed, 0 no checkpoint yet, -1 unusable (and said why)
+static int ckpt_read(const char *path, Cma *c) {
+    FILE *f = fopen(path, "r");
+    if (!f && errno == ENOENT) return 0;
+    if (!f) { perror(path); return -1; }
+    char line[512] = "", key[256];
+    int version = 0, ok = fscanf(f, "tetris-cma %d\n", &version) == 1 && version == 1;
+    run_key(key, sizeof key);
+    if (ok && fgets(line, sizeof line, f)) line[strcspn(line, "\n")] = 0;
+    if (ok && strcmp(line, key) != 0) {
+        fprintf(stderr, "%s: made with other options:\n  %s\nthis run:\n  %s\n", path, line, key);
+        fclose(f);
+        return -1;
+    }
+    ok = ok && fscanf(f, " gen %d games %ld pieces %ld", &c->gen, &c->games, &c->pieces) == 3
+            && fscanf(f, " sigma %lf", &c->sigma) == 1
+            && get_vec(f, "mean", c->m) && get_vec(f, "ps", c->ps) && get_vec(f, "pc", c->pc);
+    for (int i = 0; i < N && ok; ++i) ok = get_vec(f, "C", c->C[i]);
+    ok = ok && fscanf(f, " best_f %lf", &c->best_f) == 1 && get_vec(f, "best", c->best);
+    fclose(f);
+    if (!ok) { fprintf(stderr, "%s: not a checkpoint\n", path); return -1; }
+    return 1;
+}
+
+// ================================ MAIN ===========================
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-G generations] [-g games] [-p population] [-t threads] [-S sigma]"
+                    " [-x h,l,holes,bump,wells] [-d depth] [-f score|lines] [-F] [-r 8x8|10x20] [-l level]"
+                    " [-b bot_ms] [-T limit_s] [-s seed] [-c checkpoint]\n", argv0);
+    exit(1);
+}
+
+static void print_weights(const char *label, const double *x) {
+    printf("%s%.3f,%.3f,%.3f,%.3f,%.3f", label, x[0], x[1], x[2], x[3], x[4]);
+    if (opt_depth > 1) printf("/%d", opt_depth);
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "G:g:p:t:S:x:d:f:Fr:l:b:T:s:c:")) != -1) {
+        switch (opt) {
+            case 'G': opt_gens = atoi(optarg); break;
+            case 'g': opt_games = atoi(optarg); break;
+            case 'p': opt_pop = atoi(optarg); break;
+            case 't': opt_threads = atoi(optarg); break;
+            case 'S': opt_sigma = atof(optarg); break;
+            case 'x':
+                if (sscanf(optarg, "%lf,%lf,%lf,%lf,%lf", &opt_x0[0], &opt_x0[1], &opt_x0[2], &opt_x0[3],
+                           &opt_x0[4]) != N) usage(argv[0]);
+                break;
+            case 'd': opt_depth = atoi(optarg); break;
+            case 'f': opt_lines = strcmp(optarg, "lines") == 0; break;
+            case 'F': opt_fixed_seeds = 1; break;
+            case 'r': opt_rules = strcmp(optarg, "8x8") == 0 ? RULES_8X8 : RULES_10X20; break;
+            case 'l': opt_level = atoi(optarg); break;
+            case 'b': opt_bot_ms = atoi(optarg); break;
+            case 'T': opt_limit_ms = atol(optarg) * 1000L; break;
+            case 's': opt_seed = strtoull(optarg, NULL, 10); break;
+            case 'c': opt_ckpt = optarg; break;
+            default: usage(argv[0]);
+        }
+    }
+    if (!opt_threads) opt_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (opt_threads < 1 || opt_games < 1 || opt_gens < 1 || opt_sigma <= 0 || opt_depth < 1 ||
+        opt_depth > BOT_DEPTH_MAX || opt_bot_ms < 1 || opt_limit_ms < 1 || norm(opt_x0) == 0 ||
+        (opt_pop && (opt_pop < 4 || opt_pop >= MAX_POP)))
+        usage(argv[0]);
+
+    cma_params();
+    Cma c;
+    cma_init(&c);
+    if (opt_ckpt) {
+        int r = ckpt_read(opt_ckpt, &c);
+        if (r < 0) return 1;
+        if (r > 0) printf("resuming %s at generation %d (%ld games played)\n", opt_ckpt, c.gen, c.games);
+    }
+
+    n_cands = lambda + 1;
+    candidates = calloc((size_t)n_cands * N, sizeof *candidates);
+    results = calloc((size_t)n_cands * (size_t)opt_games, sizeof *results);
+    pthread_t *tids = calloc((size_t)opt_threads, sizeof *tids);
+    if (!candidates || !results || !tids) { perror("calloc"); return 1; }
+    pthread_barrier_init(&start_line, NULL, (unsigned)opt_threads);
+    pthread_barrier_init(&finish_line, NULL, (unsigned)opt_threads);
+    for (int i = 1; i < opt_threads; ++i) pthread_create(&tids[i], NULL, pool_thread, NULL);
+
+    printf("CMA-ES over %d weights: %d candidates + the mean, %d games each, %s, on %d threads\n",
+           N, lambda, opt_games, opt_lines ? "mean lines" : "mean score", opt_threads);
+    long t_all = now_ms(), games0 = c.games, pieces0 = c.pieces;
+    double f[MAX_POP + 1];
+    while (c.gen < opt_gens) {
+        long t0 = now_ms(), p0 = c.pieces;
+        double mean_f;
+        cma_step(&c, f, &mean_f);
+        double secs = fmax((now_ms() - t0) / 1000.0, 0.001), top = f[0];
+        for (int k = 1; k < lambda; ++k) top = fmax(top, f[k]);
+        printf("gen %3d  %6.0f games/s %8.0f pieces/s  best %9.1f  mean %9.1f  sigma %.4f  ",
+               c.gen - 1, n_cands * opt_games / secs, (c.pieces - p0) / secs, top, mean_f, c.sigma);
+        print_weights("", &candidates[lambda * N]);    // the mean that was played
+        printf("\n");
+        fflush(stdout);
+        if (opt_ckpt && ckpt_write(opt_ckpt, &c) < 0) { perror(opt_ckpt); return 1; }
+    }
+
+    atomic_store(&pool_stop, 1);
+    pthread_barrier_wait(&start_line);
+    for (int i = 1; i < opt_threads; ++i) pthread_join(tids[i], NULL);
+
+    double secs = fmax((now_ms() - t_all) / 1000.0, 0.001);
+    printf("\n%ld games in %.1f s: %.0f games/s, %.0f pieces/s on %d threads\n",
+           c.games - games0, secs, (c.games - games0) / secs, (c.pieces - pieces0) / secs, opt_threads);
+    print_weights("final mean ", c.m);
+    printf("\n");
+    if (c.best_f >= 0) {
+        printf("best mean  %.1f  ", c.best_f);
+        print_weights("", c.best);
+        printf("\n");
+    }
+    free(candidates); free(results); free(tids);
+    return 0;
+}
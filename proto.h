@@ -0,0 +1,173 @@
+// proto.h — binary protocol of server.c and its clients, and of netplay.c peers
+// Every message starts with { u8 type, u8 len } where len is the whole
+// message in bytes, so a reader can frame and skip types it does not know.
+// Multi-byte fields are little-endian. Runs over TCP or UNIX stream sockets.
+//
+//   client -> server
+//     HELLO  start (or restart) the session: rules, piece policy, level, seed
+//     INPUT  one ACT_* action, tagged with a client sequence number
+//   server -> client
+//     STATE  after every input and every gravity step that moved the piece;
+//            echoes the sequence number of the last input applied
+//   peer <-> peer (netplay.c, over UDP, one message per datagram)
+//     INPUTS a player's inputs from frame start on, how far the sender has
+//            the receiver's inputs, and the checksum of a confirmed frame
+//
+// offsets:
+//   HELLO  2 rules  3 policy  4 level  5 -  6 seed u64                   (14)
+//   INPUT  2 action 3 -       4 seq u16                                   (6)
+//   STATE  2 flags  3 h       4 seq u16  6 lines u16  8 score u32
+//          12 games u32  16 level  17 piece  18 px  19 py  20 ghost_py
+//          21 next  22 -  24 rows u16[h] (settled cells | active piece)   (24 + 2h)
+//   INPUTS 2 player 3 n  4 start u32  8 ack u32  12 check_frame u32
+//          16 checksum u64  24 actions u8[n]                              (24 + n)
+#ifndef PROTO_H
+#define PROTO_H
+
+#include <stdint.h>
+#include <string.h>
+#include "engine.h"
+
+enum {
+    MSG_HELLO = 0x01,
+    MSG_INPUT = 0x02,
+    MSG_INPUTS = 0x40,
+    MSG_STATE = 0x81,
+};
+
+#define MSG_HELLO_LEN  14
+#define MSG_INPUT_LEN  6
+#define MSG_STATE_HDR  24
+#define MSG_STATE_MAX  (MSG_STATE_HDR + 2 * EN_MAX_H)
+#define MSG_INPUTS_HDR 24
+#define MSG_INPUTS_MAX 64        // actions per INPUTS message
+#define MSG_MAX        (MSG_INPUTS_HDR + MSG_INPUTS_MAX)
+
+#define STATE_OVER 0x01          // the game ended; the next STATE is a new game
+
+typedef struct {
+    uint8_t rules, policy, level;
+    uint64_t seed;
+} MsgHello;
+
+typedef struct {
+    uint8_t action;
+    uint16_t seq;
+} MsgInput;
+
+typedef struct {
+    uint8_t flags, h;
+    uint16_t seq, lines;
+    uint32_t score, games;
+    uint8_t level;
+    int8_t piece, px, py, ghost_py, next;
+    uint16_t rows[EN_MAX_H];
+} MsgState;
+
+typedef struct {
+    uint8_t player, n;
+    uint32_t start, ack, check_frame;
+    uint64_t checksum;           // 0: no frame to compare yet
+    uint8_t actions[MSG_INPUTS_MAX];
+} MsgInputs;
+
+// ============================= ENCODING ==========================
+static inline void put16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static inline void put32(uint8_t *p, uint32_t v) { put16(p, (uint16_t)v); put16(p + 2, (uint16_t)(v >> 16)); }
+static inline uint16_t get16(const uint8_t *p) { return (uint16_t)(p[0] | p[1] << 8); }
+static inline uint32_t get32(const uint8_t *p) { return get16(p) | (uint32_t)get16(p + 2) << 16; }
+
+static inline int msg_put_hello(uint8_t *p, const MsgHello *m) {
+    p[0] = MSG_HELLO; p[1] = MSG_HELLO_LEN;
+    p[2] = m->rules; p[3] = m->policy; p[4] = m->level; p[5] = 0;
+    put32(p + 6, (uint32_t)m->seed);
+    put32(p + 10, (uint32_t)(m->seed >> 32));
+    return MSG_HELLO_LEN;
+}
+
+static inline void msg_get_hello(const uint8_t *p, MsgHello *m) {
+    m->rules = p[2]; m->policy = p[3]; m->level = p[4];
+    m->seed = get32(p + 6) | (uint64_t)get32(p + 10) << 32;
+}
+
+static inline int msg_put_input(uint8_t *p, const MsgInput *m) {
+    p[0] = MSG_INPUT; p[1] = MSG_INPUT_LEN;
+    p[2] = m->action; p[3] = 0;
+    put16(p + 4, m->seq);
+    return MSG_INPUT_LEN;
+}
+
+static inline void msg_get_input(const uint8_t *p, MsgInput *m) {
+    m->action = p[2];
+    m->seq = get16(p + 4);
+}
+
+static inline int msg_put_state(uint8_t *p, const MsgState *m) {
+    p[0] = MSG_STATE; p[1] = (uint8_t)(MSG_STATE_HDR + 2 * m->h);
+    p[2] = m->flags; p[3] = m->h;
+    put16(p + 4, m->seq); put16(p + 6, m->lines);
+    put32(p + 8, m->score); put32(p + 12, m->games);
+    p[16] = m->level;
+    p[17] = (uint8_t)m->piece; p[18] = (uint8_t)m->px; p[19] = (uint8_t)m->py;
+    p[20] = (uint8_t)m->ghost_py; p[21] = (uint8_t)m->next;
+    p[22] = p[23] = 0;
+    for (int r = 0; r < m->h; ++r) put16(p + MSG_STATE_HDR + 2 * r, m->rows[r]);
+    return p[1];
+}
+
+// 0 if the message is malformed
+static inline int msg_get_state(const uint8_t *p, MsgState *m) {
+    m->flags = p[2]; m->h = p[3];
+    if (m->h > EN_MAX_H || p[1] != MSG_STATE_HDR + 2 * m->h) return 0;
+    m->seq = get16(p + 4); m->lines = get16(p + 6);
+    m->score = get32(p + 8); m->games = get32(p + 12);
+    m->level = p[16];
+    m->piece = (int8_t)p[17]; m->px = (int8_t)p[18]; m->py = (int8_t)p[19];
+    m->ghost_py = (int8_t)p[20]; m->next = (int8_t)p[21];
+    for (int r = 0; r < m->h; ++r) m->rows[r] = get16(p + MSG_STATE_HDR + 2 * r);
+    return 1;
+}
+
+static inline int msg_put_inputs(uint8_t *p, const MsgInputs *m) {
+    p[0] = MSG_INPUTS; p[1] = (uint8_t)(MSG_INPUTS_HDR + m->n);
+    p[2] = m->player; p[3] = m->n;
+    put32(p + 4, m->start); put32(p + 8, m->ack); put32(p + 12, m->check_frame);
+    put32(p + 16, (uint32_t)m->checksum); put32(p + 20, (uint32_t)(m->checksum >> 32));
+    memcpy(p + MSG_INPUTS_HDR, m->actions, m->n);
+    return p[1];
+}
+
+// 0 if the message is malformed
+static inline int msg_get_inputs(const uint8_t *p, int len, MsgInputs *m) {
+    if (len < MSG_INPUTS_HDR || p[0] != MSG_INPUTS || p[1] != len) return 0;
+    m->player = p[2]; m->n = p[3];
+    if (m->n > MSG_INPUTS_MAX || len != MSG_INPUTS_HDR + m->n) return 0;
+    m->start = get32(p + 4); m->ack = get32(p + 8); m->check_frame = get32(p + 12);
+    m->checksum = get32(p + 16) | (uint64_t)get32(p + 20) << 32;
+    memcpy(m->actions, p + MSG_INPUTS_HDR, m->n);
+    return 1;
+}
+
+// fill a STATE from a game: settled rows with the active piece or'ed in
+static inline void msg_state_from_game(MsgState *m, const Game *g, uint16_t seq, uint32_t games) {
+    m->flags = g->over ? STATE_OVER : 0;
+    m->h = (uint8_t)g->h;
+    m->seq = seq;
+    m->lines = (uint16_t)g->lines_total;
+    m->score = (uint32_t)g->score;
+    m->games = games;
+    m->level = (uint8_t)g->level;
+    m->piece = (int8_t)g->piece; m->px = (int8_t)g->px; m->py = (int8_t)g->py;
+    m->ghost_py = (int8_t)g->ghost_py;
+    m->next = (int8_t)game_next(g, 0);
+    memcpy(m->rows, g->rows, sizeof m->rows);
+    if (g->piece >= 0)
+        for (int r = 0; r < 4; ++r) {
+            unsigned nib = (g->mask >> (r * 4)) & 0xF;
+            int gr = g->py + r;
+            if (nib && gr >= 0 && gr < g->h)
+                m->rows[gr] |= (uint16_t)(g->px >= 0 ? nib << g->px : nib >> -g->px);
+        }
+}
+
+#endif
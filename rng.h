@@ -0,0 +1,151 @@
+// rng.h — counter-based random numbers and piece randomizers
+// Shared by tetristest.c, newtetris.c and the headless engine.
+//
+// The generator is Philox4x32-10 (Salmon et al., "Parallel Random Numbers:
+// As Easy as 1, 2, 3"): block i of stream s is a pure function of
+// (seed, s, i), so
+//   - every game or thread gets its own reproducible stream, either by
+//     number (rng_init) or derived from a parent (rng_split), in O(1)
+//   - rng_skip() jumps ahead any number of draws in O(1)
+//   - only 32-bit integer arithmetic is used, so the DE10-Lite (RV32) and
+//     host builds produce the same sequence bit for bit
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t key[2];        // seed
+    uint64_t stream;        // counter words 2..3
+    uint64_t index;         // next 32-bit output; its block is index / 4
+    uint64_t cached;        // block number + 1 held in block[], 0 = none
+    uint32_t block[4];
+} Rng;
+
+// ============================= PHILOX ============================
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+
+static inline void philox4x32_10(const uint32_t key[2], const uint32_t ctr[4], uint32_t out[4]) {
+    uint32_t x0 = ctr[0], x1 = ctr[1], x2 = ctr[2], x3 = ctr[3];
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int round = 0; round < 10; ++round) {
+        uint64_t p0 = (uint64_t)PHILOX_M0 * x0;
+        uint64_t p1 = (uint64_t)PHILOX_M1 * x2;
+        x0 = (uint32_t)(p1 >> 32) ^ x1 ^ k0;
+        x1 = (uint32_t)p1;
+        x2 = (uint32_t)(p0 >> 32) ^ x3 ^ k1;
+        x3 = (uint32_t)p0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    out[0] = x0; out[1] = x1; out[2] = x2; out[3] = x3;
+}
+
+// ============================= STREAMS ===========================
+static inline void rng_init(Rng *r, uint64_t seed, uint64_t stream) {
+    r->key[0] = (uint32_t)seed;
+    r->key[1] = (uint32_t)(seed >> 32);
+    r->stream = stream;
+    r->index = 0;
+    r->cached = 0;
+}
+
+// independent child stream number id of r (same seed, hashed stream number)
+static inline Rng rng_split(const Rng *r, uint64_t id) {
+    uint64_t z = r->stream + 0x9E3779B97F4A7C15ull * (id + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    Rng child;
+    rng_init(&child, (uint64_t)r->key[1] << 32 | r->key[0], z);
+    return child;
+}
+
+static inline void rng_skip(Rng *r, uint64_t draws) { r->index += draws; }
+
+static inline uint32_t rng_u32(Rng *r) {
+    uint64_t b = r->index >> 2;
+    if (r->cached != b + 1) {
+        uint32_t ctr[4] = {
+            (uint32_t)b, (uint32_t)(b >> 32), (uint32_t)r->stream, (uint32_t)(r->stream >> 32)
+        };
+        philox4x32_10(r->key, ctr, r->block);
+        r->cached = b + 1;
+    }
+    return r->block[r->index++ & 3];
+}
+
+// unbiased 0..n-1 (multiply-shift with rejection of the short interval)
+static inline uint32_t rng_below(Rng *r, uint32_t n) {
+    uint64_t m = (uint64_t)rng_u32(r) * n;
+    if ((uint32_t)m < n) {
+        uint32_t t = (uint32_t)(0u - n) % n;
+        while ((uint32_t)m < t) m = (uint64_t)rng_u32(r) * n;
+    }
+    return (uint32_t)(m >> 32);
+}
+
+// ============================= PIECES ============================
+// Preview queue of upcoming pieces. The uniform policy draws each piece
+// independently; the bag policy deals shuffled bags holding every piece
+// type once. Refills append whole bags at a time, so at least
+// PIECE_PREVIEW_MAX pieces after the current one can always be peeked.
+#define PIECE_QUEUE_LEN   16     // power of two
+#define PIECE_KINDS_MAX   7
+#define PIECE_PREVIEW_MAX (PIECE_QUEUE_LEN - PIECE_KINDS_MAX)
+
+typedef enum { PIECES_UNIFORM, PIECES_BAG } PiecePolicy;
+
+typedef struct {
+    Rng rng;
+    uint8_t q[PIECE_QUEUE_LEN];
+    uint8_t head, count;
+    uint8_t kinds;           // 6 on the 8x8 board, 7 on 10x20
+    uint8_t policy;
+} PieceQueue;
+
+static inline void pieces_push(PieceQueue *pq, int piece) {
+    pq->q[(pq->head + pq->count++) & (PIECE_QUEUE_LEN - 1)] = (uint8_t)piece;
+}
+
+static inline void pieces_refill(PieceQueue *pq) {
+    if (pq->policy == PIECES_BAG) {
+        while (PIECE_QUEUE_LEN - pq->count >= pq->kinds) {
+            uint8_t bag[PIECE_KINDS_MAX];
+            for (int i = 0; i < pq->kinds; ++i) bag[i] = (uint8_t)i;
+            for (int i = pq->kinds - 1; i > 0; --i) {          // Fisher-Yates
+                int j = (int)rng_below(&pq->rng, (uint32_t)i + 1);
+                uint8_t t = bag[i]; bag[i] = bag[j]; bag[j] = t;
+            }
+            for (int i = 0; i < pq->kinds; ++i) pieces_push(pq, bag[i]);
+        }
+    } else {
+        while (pq->count < PIECE_QUEUE_LEN) pieces_push(pq, (int)rng_below(&pq->rng, pq->kinds));
+    }
+}
+
+static inline void pieces_init(PieceQueue *pq, Rng rng, int kinds, PiecePolicy policy) {
+    pq->rng = rng;
+    pq->head = pq->count = 0;
+    pq->kinds = (uint8_t)kinds;
+    pq->policy = (uint8_t)policy;
+    pieces_refill(pq);
+}
+
+// i-th piece after the current front (0 = the next one to be dealt)
+static inline int pieces_peek(const PieceQueue *pq, int i) {
+    return pq->q[(pq->head + i) & (PIECE_QUEUE_LEN - 1)];
+}
+
+static inline int pieces_next(PieceQueue *pq) {
+    int piece = pq->q[pq->head];
+    pq->head = (uint8_t)((pq->head + 1) & (PIECE_QUEUE_LEN - 1));
+    pq->count--;
+    if (pq->count <= PIECE_PREVIEW_MAX) pieces_refill(pq);
+    return piece;
+}
+
+#endif
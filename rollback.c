@@ -0,0 +1,100 @@
+// rollback.c — rollback netcode for head-to-head matches (see rollback.h)
+// build: linked into netplay, e.g.
+//        gcc -O2 -std=c11 netplay.c rollback.c engine.c bot.c -o netplay
+#include <string.h>
+#include "rollback.h"
+
+#define SLOT(f) ((f) & (RB_RING - 1))
+
+void rb_init(Rollback *rb, int players, int local, Rules rules, uint64_t seed,
+             int frame_ms, int window, int delay) {
+    memset(rb, 0, sizeof *rb);
+    rb->players = players;
+    rb->local = local;
+    rb->frame_ms = frame_ms;
+    rb->window = window < 1 ? 1 : window > RB_MAX_WINDOW ? RB_MAX_WINDOW : window;
+    rb->delay = delay < 0 ? 0 : delay >= rb->window ? rb->window - 1 : delay;
+    rb->first_wrong = UINT32_MAX;
+    Rng root;
+    rng_init(&root, seed, 0);
+    for (int p = 0; p < players; ++p)        // same piece stream for every player
+        game_init(&rb->cur.g[p], rules, rng_split(&root, 0), 0);
+    rb->confirmed[local] = (uint32_t)rb->delay;    // the delayed frames have no input
+}
+
+int rb_can_advance(const Rollback *rb) {
+    for (int p = 0; p < rb->players; ++p)
+        if (p != rb->local && (int32_t)(rb->cur.frame - rb->confirmed[p]) >= rb->window) return 0;
+    return 1;
+}
+
+void rb_add_local(Rollback *rb, uint8_t action) {
+    uint32_t f = rb->cur.frame + (uint32_t)rb->delay;
+    if (f < rb->confirmed[rb->local]) return;      // already given for this frame
+    rb->input[SLOT(f)][rb->local] = action;
+    rb->confirmed[rb->local] = f + 1;
+}
+
+int rb_add_remote(Rollback *rb, int player, uint32_t frame, uint8_t action) {
+    if (frame < rb->confirmed[player]) return 1;   // a repeat
+    if (frame > rb->confirmed[player]) return 0;   // a gap: wait for a resend
+    if (frame >= rb->cur.frame + RB_RING - (uint32_t)rb->window) return 0; // no slot yet
+    if (frame < rb->cur.frame) {                   // already simulated on a prediction
+        if (rb->input[SLOT(frame)][player] != action && frame < rb->first_wrong)
+            rb->first_wrong = frame;
+    }
+    rb->input[SLOT(frame)][player] = action;
+    rb->confirmed[player] = frame + 1;
+    return 1;
+}
+
+uint32_t rb_confirmed_frame(const Rollback *rb) {
+    uint32_t f = rb->cur.frame;
+    for (int p = 0; p < rb->players; ++p)
+        if (rb->confirmed[p] < f) f = rb->confirmed[p];
+    return f;
+}
+
+uint64_t rb_match_checksum(const Match *m, int players) {
+    uint64_t h = m->frame;
+    for (int p = 0; p < players; ++p) h = h * 0x9E3779B97F4A7C15ull ^ game_checksum(&m->g[p]);
+    return h;
+}
+
+uint64_t rb_checksum_at(const Rollback *rb, uint32_t frame) {
+    if (frame > rb_confirmed_frame(rb) || frame > rb->first_wrong) return 0;  // not final yet
+    if (frame >= rb->cur.frame || rb->cur.frame - frame > RB_RING) return 0;  // not in the ring
+    return rb->check[SLOT(frame)];
+}
+
+// one frame: save the match, predict what is missing, apply and tick
+static void simulate(Rollback *rb) {
+    uint32_t f = rb->cur.frame;
+    rb->saved[SLOT(f)] = rb->cur;
+    rb->check[SLOT(f)] = rb_match_checksum(&rb->cur, rb->players);
+    for (int p = 0; p < rb->players; ++p) {
+        if (f >= rb->confirmed[p]) rb->input[SLOT(f)][p] = ACT_NONE;     // prediction
+        Game *g = &rb->cur.g[p];
+        if (g->over) continue;
+        game_apply(g, rb->input[SLOT(f)][p]);
+        game_tick(g, rb->frame_ms);
+    }
+    rb->cur.frame = f + 1;
+}
+
+void rb_sync(Rollback *rb) {
+    if (rb->first_wrong < rb->cur.frame) {
+        uint32_t now = rb->cur.frame, depth = now - rb->first_wrong;
+        rb->cur = rb->saved[SLOT(rb->first_wrong)];
+        while (rb->cur.frame < now) simulate(rb);
+        rb->rollbacks++;
+        rb->resimulated += depth;
+        if (depth > (uint32_t)rb->max_depth) rb->max_depth = depth;
+    }
+    rb->first_wrong = UINT32_MAX;
+}
+
+void rb_advance(Rollback *rb) {
+    rb_sync(rb);
+    simulate(rb);
+}
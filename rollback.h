@@ -0,0 +1,73 @@
+// rollback.h — rollback netcode for head-to-head matches (GGPO style)
+// Each peer simulates every frame as soon as its own input is known,
+// predicting the inputs of the other players. A snapshot of the match is
+// kept for each frame in the window; when a remote input arrives that
+// differs from the prediction, the match is restored to the frame it belongs
+// to and re-simulated up to the present in the same call.
+//
+// A snapshot is a struct copy (engine.h: Game holds no pointers), a few
+// hundred bytes per player. Inputs are ACT_* events rather than held
+// buttons, so a missing remote input is predicted as ACT_NONE rather than a
+// repeat of the last one, which would replay a move or a hard drop.
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include <stdint.h>
+#include "engine.h"
+
+#define RB_MAX_PLAYERS 2
+#define RB_RING        32     // frames of snapshots and inputs kept, power of two
+#define RB_MAX_WINDOW  (RB_RING / 2)
+
+typedef struct {
+    Game g[RB_MAX_PLAYERS];
+    uint32_t frame;           // frames simulated so far
+} Match;
+
+typedef struct {
+    int players, local;
+    int frame_ms;             // game time per frame
+    int window;               // frames the local peer may run ahead of a remote
+    int delay;                // local input delay in frames
+    Match cur;
+    Match saved[RB_RING];     // match at the start of frame f, by f % RB_RING
+    uint64_t check[RB_RING];  // rb_match_checksum of saved[]
+    uint8_t input[RB_RING][RB_MAX_PLAYERS];
+    uint32_t confirmed[RB_MAX_PLAYERS];   // inputs of frames below this are final
+    uint32_t first_wrong;     // earliest mispredicted frame, UINT32_MAX if none
+
+    long rollbacks, resimulated, max_depth;
+} Rollback;
+
+// every peer must pass the same rules, seed and frame_ms
+void rb_init(Rollback *rb, int players, int local, Rules rules, uint64_t seed,
+             int frame_ms, int window, int delay);
+
+// the local peer may simulate another frame without running more than
+// window frames past the last confirmed remote input
+int rb_can_advance(const Rollback *rb);
+
+// local input for the frame now being simulated (applied delay frames later)
+void rb_add_local(Rollback *rb, uint8_t action);
+
+// remote input of player for frame; frames must arrive in order, repeats and
+// anything already confirmed are ignored. Returns 0 for a gap.
+int rb_add_remote(Rollback *rb, int player, uint32_t frame, uint8_t action);
+
+// re-simulate from the earliest misprediction, if there is one, up to the
+// current frame
+void rb_sync(Rollback *rb);
+
+// rb_sync(), then simulate the next frame
+void rb_advance(Rollback *rb);
+
+// all inputs of frames below this are confirmed on this peer
+uint32_t rb_confirmed_frame(const Rollback *rb);
+
+uint64_t rb_match_checksum(const Match *m, int players);
+
+// checksum of the match at the start of frame, if that frame is confirmed
+// and still in the ring; 0 otherwise
+uint64_t rb_checksum_at(const Rollback *rb, uint32_t frame);
+
+#endif
@@ -0,0 +1,211 @@
+// scorebench.c — load test of the high-score store in scores.h
+// build: gcc -O2 -std=c11 -pthread scorebench.c scores.c engine.c bot.c -o scorebench
+// run:   ./scorebench -t 8 -r 2 -d 5 -o scores.log
+//
+// Submitter threads feed finished games into one ScoreBoard as fast as they
+// can while reader threads pull top-K tables from random buckets and check
+// that every table is whole: sorted, the right bucket, intact records. By
+// default the games are synthetic records (a batch run's rate, without the
+// cost of playing); -g plays real bot games instead. At the end the log is
+// reopened and the rebuilt tables compared with the live ones.
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "engine.h"
+#include "bot.h"
+#include "scores.h"
+
+// ============================= TIMING ============================
+static long now_ns(void) {
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)(ts.tv_sec*1000000000LL + ts.tv_nsec);
+}
+
+// ============================= OPTIONS ===========================
+static int opt_threads = 4;
+static int opt_readers = 1;
+static int opt_seconds = 5;
+static int opt_play = 0;             // -g: real bot games
+static int opt_seeds = 1000;         // distinct seeds
+static const char *opt_log = "scores.log";
+static uint64_t opt_seed = 1;
+
+static ScoreBoard *board;
+static atomic_int done;
+
+// ============================= SUBMITTERS ========================
+typedef struct {
+    int id;
+    pthread_t tid;
+    ScoreWriter w;
+    long submitted, ranked;
+} Submitter;
+
+static void fake_game(ScoreRec *r, Rng *rng, uint32_t player) {
+    memset(r, 0, sizeof *r);
+    r->seed = rng_below(rng, (uint32_t)opt_seeds);
+    r->player = player;
+    r->rules = rng_below(rng, 4) ? RULES_10X20 : RULES_8X8;
+    r->start_level = (uint8_t)rng_below(rng, 10);
+    uint32_t pieces = 20 + rng_below(rng, 200) * (1 + rng_below(rng, 8)); // long tail
+    r->lines = pieces * 2 / 5;
+    r->score = r->lines * 100 + rng_below(rng, 100) * 100;
+    r->level = (uint16_t)(r->start_level + r->lines / 10);
+    r->duration_ms = pieces * 900;
+}
+
+static void real_game(ScoreRec *r, Rng *rng, uint32_t player) {
+    uint64_t seed = rng_below(rng, (uint32_t)opt_seeds);
+    Rng gr;
+    rng_init(&gr, seed, 0);
+    Game g;
+    game_init(&g, rng_below(rng, 4) ? RULES_10X20 : RULES_8X8, gr, (int)rng_below(rng, 10));
+    Bot b;
+    BotWeights w = BOT_DEFAULT_WEIGHTS;
+    w.holes *= 0.5 + (rng_below(rng, 100) / 100.0);   // some variety between games
+    bot_init(&b, &w);
+    while (!g.over && g.time_ms < 600000) {
+        game_apply(&g, bot_next_action(&b, &g));
+        game_tick(&g, 50);
+    }
+    score_from_game(r, &g, player, seed);
+}
+
+static void *submit_main(void *arg) {
+    Submitter *s = arg;
+    Rng rng;
+    rng_init(&rng, opt_seed, (uint64_t)s->id);
+    score_writer_init(&s->w, board);
+    while (!atomic_load_explicit(&done, memory_order_relaxed)) {
+        ScoreRec r;
+        for (int i = 0; i < 64; ++i) {
+            if (opt_play) real_game(&r, &rng, (uint32_t)s->id);
+            else fake_game(&r, &rng, (uint32_t)s->id);
+            score_submit(&s->w, &r);
+        }
+    }
+    score_writer_flush(&s->w);
+    return NULL;
+}
+
+// ============================= READERS ===========================
+typedef struct {
+    int id;
+    pthread_t tid;
+    long reads, entries, bad;
+} Reader;
+
+static int table_ok(int bucket, const ScoreRec *t, int n) {
+    if (n < 0 || n > SCORE_TOP_K) return 0;
+    for (int i = 0; i < n; ++i) {
+        ScoreRec c = t[i];
+        c.check = 0;
+        ScoreRec again;
+        Game g;                                      // recompute the check through the public path
+        memset(&g, 0, sizeof g);
+        g.score = (int)c.score; g.lines_total = (int)c.lines; g.time_ms = c.duration_ms;
+        g.level = c.level; g.start_level = c.start_level; g.rules = (Rules)c.rules;
+        score_from_game(&again, &g, c.player, c.seed);
+        if (again.check != t[i].check) return 0;
+        if (score_bucket((Rules)c.rules, c.start_level, c.seed) != bucket) return 0;
+        if (i && t[i - 1].score < t[i].score) return 0;
+    }
+    return 1;
+}
+
+static void *read_main(void *arg) {
+    Reader *rd = arg;
+    Rng rng;
+    rng_init(&rng, opt_seed ^ 0x5EED, (uint64_t)rd->id);
+    ScoreRec t[SCORE_TOP_K];
+    while (!atomic_load_explicit(&done, memory_order_relaxed)) {
+        int bucket = (int)rng_below(&rng, SCORE_BUCKETS);
+        int n = scores_top(board, bucket, t);
+        if (!table_ok(bucket, t, n)) rd->bad++;
+        rd->reads++;
+        rd->entries += n;
+    }
+    return NULL;
+}
+
+// ================================ MAIN ===========================
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-t submitters] [-r readers] [-d seconds] [-n seeds] [-o log] [-s seed] [-g]\n", argv0);
+    exit(1);
+}
+
+static int same_scores(ScoreBoard *a, ScoreBoard *b) {
+    ScoreRec ta[SCORE_TOP_K], tb[SCORE_TOP_K];
+    for (int k = 0; k < SCORE_BUCKETS; ++k) {
+        int na = scores_top(a, k, ta), nb = scores_top(b, k, tb);
+        if (na != nb) return 0;
+        for (int i = 0; i < na; ++i) if (ta[i].score != tb[i].score) return 0;  // ties may swap
+    }
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "t:r:d:n:o:s:g")) != -1) {
+        switch (opt) {
+            case 't': opt_threads = atoi(optarg); break;
+            case 'r': opt_readers = atoi(optarg); break;
+            case 'd': opt_seconds = atoi(optarg); break;
+            case 'n': opt_seeds = atoi(optarg); break;
+            case 'o': opt_log = optarg; break;
+            case 's': opt_seed = strtoull(optarg, NULL, 10); break;
+            case 'g': opt_play = 1; break;
+            default: usage(argv[0]);
+        }
+    }
+    if (opt_threads < 1 || opt_readers < 0 || opt_seconds < 1 || opt_seeds < 1) usage(argv[0]);
+
+    long replayed;
+    long t0 = now_ns();
+    board = scores_open(opt_log, &replayed);
+    if (!board) { fprintf(stderr, "%s: %s\n", opt_log, strerror(errno)); return 1; }
+    printf("opened %s: %ld games replayed in %.1f ms, %ld damaged bytes skipped\n",
+           opt_log, replayed, (now_ns() - t0) / 1e6, board->damaged);
+
+    Submitter *subs = calloc((size_t)opt_threads, sizeof *subs);
+    Reader *rds = calloc((size_t)opt_readers + 1, sizeof *rds);
+    if (!subs || !rds) { perror("calloc"); return 1; }
+    long start = now_ns();
+    for (int i = 0; i < opt_threads; ++i) { subs[i].id = i; pthread_create(&subs[i].tid, NULL, submit_main, &subs[i]); }
+    for (int i = 0; i < opt_readers; ++i) { rds[i].id = i; pthread_create(&rds[i].tid, NULL, read_main, &rds[i]); }
+    sleep((unsigned)opt_seconds);
+    atomic_store(&done, 1);
+    long submitted = 0, ranked = 0, errors = 0, lost = 0, reads = 0, entries = 0, bad = 0;
+    for (int i = 0; i < opt_threads; ++i) {
+        pthread_join(subs[i].tid, NULL);
+        submitted += subs[i].w.submitted; ranked += subs[i].w.ranked; errors += subs[i].w.errors; lost += subs[i].w.lost;
+    }
+    for (int i = 0; i < opt_readers; ++i) {
+        pthread_join(rds[i].tid, NULL);
+        reads += rds[i].reads; entries += rds[i].entries; bad += rds[i].bad;
+    }
+    double secs = (now_ns() - start) / 1e9;
+    printf("%d submitters: %ld games in %.2f s, %.0f/s, %ld ranked, %ld write errors, %ld lost\n",
+           opt_threads, submitted, secs, submitted / secs, ranked, errors, lost);
+    printf("%d readers: %ld top-%d reads, %.0f/s, %.1f entries each, %ld inconsistent\n",
+           opt_readers, reads, SCORE_TOP_K, reads / secs, reads ? (double)entries / reads : 0.0, bad);
+
+    // the log alone must give back the same tables
+    t0 = now_ns();
+    ScoreBoard *again = scores_open(opt_log, &replayed);
+    if (!again) { fprintf(stderr, "%s: %s\n", opt_log, strerror(errno)); return 1; }
+    long t1 = now_ns();
+    int same = same_scores(board, again);
+    printf("reopened: %ld games replayed in %.1f ms (%.0f/s), tables %s\n",
+           replayed, (t1 - t0) / 1e6, replayed / ((t1 - t0) / 1e9), same ? "match" : "DIFFER");
+    scores_close(again);
+    scores_close(board);
+    free(subs); free(rds);
+    return bad || errors || lost || !same ? 1 : 0;
+}
@@ -0,0 +1,185 @@
+// scores.c — high-score log and top-K tables (see scores.h)
+// build: linked into the tools that record games, e.g.
+//        gcc -O2 -std=c11 -pthread scorebench.c scores.c engine.c bot.c -o scorebench
+#define _DEFAULT_SOURCE
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "scores.h"
+
+// ============================= Records ===========================
+static uint32_t record_check(const ScoreRec *r) {
+    const uint8_t *p = (const uint8_t *)r;
+    uint32_t h = 0x811C9DC5u;
+    for (size_t i = 0; i < offsetof(ScoreRec, check); ++i) h = (h ^ p[i]) * 0x01000193u;
+    return h;
+}
+
+void score_from_game(ScoreRec *r, const Game *g, uint32_t player, uint64_t seed) {
+    memset(r, 0, sizeof *r);
+    r->seed = seed;
+    r->player = player;
+    r->score = (uint32_t)g->score;
+    r->lines = (uint32_t)g->lines_total;
+    r->duration_ms = (uint32_t)g->time_ms;
+    r->level = (uint16_t)g->level;
+    r->start_level = (uint8_t)g->start_level;
+    r->rules = (uint8_t)g->rules;
+    r->check = record_check(r);
+}
+
+int score_bucket(Rules rules, int start_level, uint64_t seed) {
+    if (start_level < 0) start_level = 0;
+    if (start_level >= SCORE_LEVELS) start_level = SCORE_LEVELS - 1;
+    uint64_t z = seed * 0x9E3779B97F4A7C15ull;         // spread sequential seeds
+    int sb = (int)(z >> 60) % SCORE_SEED_BUCKETS;
+    return ((rules == RULES_8X8 ? 0 : 1) * SCORE_LEVELS + start_level) * SCORE_SEED_BUCKETS + sb;
+}
+
+// ============================= Tables ============================
+static int rank_in(ScoreBucket *k, const ScoreRec *r) {
+    if (k->n == SCORE_TOP_K && r->score <= k->top[SCORE_TOP_K - 1].score) return -1;
+    int at = k->n < SCORE_TOP_K ? k->n : SCORE_TOP_K - 1;
+    while (at > 0 && k->top[at - 1].score < r->score) --at;
+
+    unsigned seq = atomic_load_explicit(&k->seq, memory_order_relaxed);
+    atomic_store_explicit(&k->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    int last = k->n < SCORE_TOP_K ? k->n++ : SCORE_TOP_K - 1;
+    memmove(&k->top[at + 1], &k->top[at], (size_t)(last - at) * sizeof *r);
+    k->top[at] = *r;
+    atomic_store_explicit(&k->seq, seq + 2, memory_order_release);
+    if (k->n == SCORE_TOP_K)
+        atomic_store_explicit(&k->entry, k->top[SCORE_TOP_K - 1].score + 1, memory_order_relaxed);
+    return at;
+}
+
+static int rank(ScoreBoard *b, const ScoreRec *r) {
+    ScoreBucket *k = &b->buckets[score_bucket((Rules)r->rules, r->start_level, r->seed)];
+    if (r->score < atomic_load_explicit(&k->entry, memory_order_relaxed)) return -1;  // the usual case: no lock
+    pthread_mutex_lock(&k->lock);
+    int at = rank_in(k, r);
+    pthread_mutex_unlock(&k->lock);
+    return at;
+}
+
+int scores_top(ScoreBoard *b, int bucket, ScoreRec *out) {
+    ScoreBucket *k = &b->buckets[bucket];
+    for (;;) {
+        unsigned s1 = atomic_load_explicit(&k->seq, memory_order_acquire);
+        if (s1 & 1) continue;
+        int n = k->n;
+        memcpy(out, k->top, sizeof k->top);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&k->seq, memory_order_relaxed) == s1) return n;
+    }
+}
+
+// ============================== Log ==============================
+ScoreBoard *scores_open(const char *path, long *replayed) {
+    ScoreBoard *b = calloc(1, sizeof *b);
+    if (!b) return NULL;
+    for (int i = 0; i < SCORE_BUCKETS; ++i) pthread_mutex_init(&b->buckets[i].lock, NULL);
+    pthread_mutex_init(&b->log_lock, NULL);
+    b->fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (b->fd < 0) { int e = errno; free(b); errno = e; return NULL; }
+
+    // replay. A record that fails its check is passed over a byte at a
+    // time until the records line up again, so damage in the middle costs
+    // only the damaged bytes; whatever follows the last good record is a
+    // torn tail (a crash mid-write) and is cut off so new appends start on
+    // a record boundary.
+    uint8_t buf[SCORE_BATCH * sizeof(ScoreRec)];
+    size_t have = 0;
+    long n = 0;
+    off_t at = 0, good = 0;                            // file offsets of buf[0], of the end of the last good record
+    for (;;) {
+        ssize_t k = read(b->fd, buf + have, sizeof buf - have);
+        if (k < 0 && errno == EINTR) continue;
+        if (k < 0) { int e = errno; scores_close(b); errno = e; return NULL; }
+        have += (size_t)k;
+        size_t pos = 0;
+        while (have - pos >= sizeof(ScoreRec)) {
+            ScoreRec r;
+            memcpy(&r, buf + pos, sizeof r);
+            if (r.check != record_check(&r)) { pos++; continue; }
+            rank(b, &r);
+            n++;
+            pos += sizeof r;
+            good = at + (off_t)pos;
+        }
+        memmove(buf, buf + pos, have - pos);
+        at += (off_t)pos;
+        have -= pos;
+        if (k == 0) break;
+    }
+    b->damaged = (long)good - n * (long)sizeof(ScoreRec);
+    struct stat st;
+    if (fstat(b->fd, &st) == 0 && st.st_size != good && ftruncate(b->fd, good) < 0) {
+        int e = errno; scores_close(b); errno = e; return NULL;
+    }
+    if (replayed) *replayed = n;
+    return b;
+}
+
+void scores_close(ScoreBoard *b) {
+    if (!b) return;
+    close(b->fd);
+    for (int i = 0; i < SCORE_BUCKETS; ++i) pthread_mutex_destroy(&b->buckets[i].lock);
+    pthread_mutex_destroy(&b->log_lock);
+    free(b);
+}
+
+void score_writer_init(ScoreWriter *w, ScoreBoard *b) {
+    memset(w, 0, sizeof *w);
+    w->b = b;
+}
+
+// the batch goes out under the log lock, so the rest of a short write()
+// follows it directly rather than after another thread's batch. On an
+// error the records not wholly written stay for the next flush, and the
+// half of one that did get out is cut off again.
+int score_writer_flush(ScoreWriter *w) {
+    size_t len = (size_t)w->n * sizeof *w->batch, done = 0;
+    if (!len) return 0;
+    const uint8_t *p = (const uint8_t *)w->batch;
+    int e = 0;
+    pthread_mutex_lock(&w->b->log_lock);
+    while (done < len) {
+        ssize_t k = write(w->b->fd, p + done, len - done);
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) { e = k < 0 ? errno : EIO; break; }   // disk full or the like
+        done += (size_t)k;
+    }
+    off_t torn = (off_t)(done % sizeof *w->batch), end;
+    if (torn && (end = lseek(w->b->fd, 0, SEEK_END)) >= torn && ftruncate(w->b->fd, end - torn) < 0)
+        torn = 0;                                       // stays in the file for the replay to pass over
+    pthread_mutex_unlock(&w->b->log_lock);
+
+    int sent = (int)(done / sizeof *w->batch);
+    w->n -= sent;
+    if (!w->n) return 0;
+    memmove(w->batch, w->batch + sent, (size_t)w->n * sizeof *w->batch);
+    w->errors++;
+    errno = e;
+    return -1;
+}
+
+int score_submit(ScoreWriter *w, const ScoreRec *r) {
+    w->submitted++;
+    if (w->n == SCORE_BATCH && score_writer_flush(w) < 0 && w->n == SCORE_BATCH) {
+        w->lost++;                                      // ranked but never logged would not survive a restart
+        return -1;
+    }
+    ScoreRec *slot = &w->batch[w->n++];
+    *slot = *r;
+    slot->check = record_check(slot);
+    int at = rank(w->b, slot);
+    if (at >= 0) w->ranked++;
+    if (w->n == SCORE_BATCH) score_writer_flush(w);
+    return at;
+}
@@ -0,0 +1,85 @@
+// scores.h — persistent high scores: an append-only log and top-K tables
+// Every finished game is one 32-byte ScoreRec appended to the log file;
+// the log is the truth and is replayed into memory when it is opened.
+// In memory, games are ranked per (rules, start level, seed bucket), each
+// bucket a top-K table of its own:
+//   submit  a game below the bucket's current floor (most of them, once
+//           the tables fill up) only reads one atomic; a game that ranks
+//           takes that bucket's mutex, never a global one
+//   read    a top-K copy is taken under the bucket's seqlock, so readers
+//           never block submitters and always get one consistent table
+// Log appends go through a ScoreWriter per thread, which batches records
+// and appends each batch under the log lock, finishing a short write()
+// before another batch can start, so batches never interleave.
+#ifndef SCORES_H
+#define SCORES_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "engine.h"
+
+#define SCORE_TOP_K        10
+#define SCORE_LEVELS       30        // start levels ranked separately; above go in the last
+#define SCORE_SEED_BUCKETS 16
+#define SCORE_BUCKETS      (2 * SCORE_LEVELS * SCORE_SEED_BUCKETS)
+#define SCORE_BATCH        256       // records per ScoreWriter write()
+
+typedef struct {
+    uint64_t seed;
+    uint32_t player, score, lines, duration_ms;
+    uint16_t level;
+    uint8_t start_level, rules;
+    uint32_t check;                  // FNV-1a of the bytes before it; catches a torn tail
+} ScoreRec;
+
+_Static_assert(sizeof(ScoreRec) == 32, "ScoreRec is the log format");
+
+typedef struct {
+    _Alignas(64) atomic_uint seq;    // odd while the table is being changed
+    atomic_uint entry;               // least score that ranks once the table is full
+    pthread_mutex_t lock;            // submitters that rank
+    int n;
+    ScoreRec top[SCORE_TOP_K];       // best first; equal scores keep their order
+} ScoreBucket;
+
+typedef struct {
+    int fd;
+    long damaged;                    // bytes of the log the replay had to pass over
+    pthread_mutex_t log_lock;        // held across one batch's write() calls
+    ScoreBucket buckets[SCORE_BUCKETS];
+} ScoreBoard;
+
+typedef struct {
+    ScoreBoard *b;
+    long submitted, ranked, errors;  // this thread's, so nothing shared is counted
+    long lost;                       // games neither logged nor ranked: the log kept failing
+    int n;
+    ScoreRec batch[SCORE_BATCH];
+} ScoreWriter;
+
+// the record of a finished game
+void score_from_game(ScoreRec *r, const Game *g, uint32_t player, uint64_t seed);
+int score_bucket(Rules rules, int start_level, uint64_t seed);
+
+// open (or create) the log at path and replay it into the tables;
+// NULL with errno set on failure. *replayed gets the records read;
+// damaged records are skipped (see ->damaged), a torn tail is cut off.
+ScoreBoard *scores_open(const char *path, long *replayed);
+void scores_close(ScoreBoard *b);
+
+void score_writer_init(ScoreWriter *w, ScoreBoard *b);
+// log and rank one game; returns its rank in its bucket (0 = best), -1 if
+// it did not make the table. The record reaches the log by the next flush
+// that succeeds; while the log cannot be written a full batch waits, and
+// games past it are dropped before they rank (counted in ->lost).
+int score_submit(ScoreWriter *w, const ScoreRec *r);
+// -1 with errno set if the log could not be written; the records not in
+// it stay in the batch for the next flush
+int score_writer_flush(ScoreWriter *w);
+
+// consistent copy of a bucket's table into out (SCORE_TOP_K records);
+// returns the number of entries
+int scores_top(ScoreBoard *b, int bucket, ScoreRec *out);
+
+#endif
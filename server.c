@@ -0,0 +1,589 @@
+// server.c — hosts thousands of headless game sessions over TCP / UNIX sockets
+// build: gcc -O2 -std=c11 -pthread server.c scores.c metrics.c engine.c -o server
+// run:   ./server -p 7000 -w 4            (or -u /tmp/tetris.sock; -H scores.log keeps high scores)
+//        ./server -p 7000 -M /dev/shm/tetris.metrics   and   ./metricstop /dev/shm/tetris.metrics
+//        ./loadgen -p 7000 -c 4000 -d 10  (loopback load test, see loadgen.c)
+//
+// The main thread accepts connections and deals them round-robin to a few
+// worker threads; a session then lives on one worker for good, so its game
+// is only ever touched by that thread. Each worker waits in epoll on its
+// sockets and a 1 ms timerfd that turns a timer wheel. A session's timer is
+// set to the moment game_due_ms() says its piece next falls or locks, so an
+// idle game costs nothing between gravity steps, however many there are.
+// Messages are in proto.h. Every few seconds the server prints sessions,
+// traffic, CPU per worker and how late the gravity timers fired. With -H,
+// every finished game goes into the high-score log of scores.h, each
+// worker appending through its own ScoreWriter. With -M, each worker also
+// keeps a slot of a shared metrics segment (metrics.h) up to date: the
+// engine's counts, games ended, games in play and the time of each pass of
+// its loop, for metricstop.c or anything else to read from outside.
+#define _GNU_SOURCE       // pthread_setaffinity_np, accept4
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "engine.h"
+#include "proto.h"
+#include "scores.h"
+#include "metrics.h"
+
+// ============================= TIMING ============================
+static long now_us(void) {
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)(ts.tv_sec*1000000LL + ts.tv_nsec/1000LL);
+}
+static long now_ns(void) {
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)(ts.tv_sec*1000000000LL + ts.tv_nsec);
+}
+static long thread_cpu_us(void) {
+    struct timespec ts; clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (long)(ts.tv_sec*1000000LL + ts.tv_nsec/1000LL);
+}
+
+// ============================= OPTIONS ===========================
+static int opt_port = 0;
+static const char *opt_unix = NULL;
+static int opt_workers = 2;
+static int opt_pin = 0;              // pin worker i to CPU i
+static int opt_stats_s = 5;
+static const char *opt_scores = NULL; // high-score log
+static const char *opt_metrics = NULL; // shared metrics segment
+
+// ============================= TIMER WHEEL =======================
+// One slot per ms; a timer more than WHEEL_SLOTS ms out stays in its slot
+// until a later turn reaches its due time.
+#define WHEEL_SLOTS 1024             // power of two
+
+typedef struct Timer {
+    struct Timer *next, **pprev;     // pprev == NULL: not scheduled
+    long due_ms;
+} Timer;
+
+typedef struct {
+    Timer *slot[WHEEL_SLOTS];
+    long now_ms;                     // every slot up to here has been run
+} Wheel;
+
+static void timer_del(Timer *t) {
+    if (!t->pprev) return;
+    *t->pprev = t->next;
+    if (t->next) t->next->pprev = t->pprev;
+    t->pprev = NULL;
+}
+
+static void timer_add(Wheel *w, Timer *t, long due_ms) {
+    timer_del(t);
+    if (due_ms <= w->now_ms) due_ms = w->now_ms + 1;
+    Timer **head = &w->slot[due_ms & (WHEEL_SLOTS - 1)];
+    t->due_ms = due_ms;
+    t->next = *head;
+    t->pprev = head;
+    if (*head) (*head)->pprev = &t->next;
+    *head = t;
+}
+
+// run the slots from the last turn up to now_ms; fire() may re-add its timer
+static void wheel_turn(Wheel *w, long now_ms, void (*fire)(Timer *, void *), void *arg) {
+    long from = w->now_ms + 1;
+    if (now_ms - from >= WHEEL_SLOTS) from = now_ms - WHEEL_SLOTS + 1;
+    w->now_ms = now_ms;
+    for (long ms = from; ms <= now_ms; ++ms) {
+        Timer *t = w->slot[ms & (WHEEL_SLOTS - 1)];
+        w->slot[ms & (WHEEL_SLOTS - 1)] = NULL;
+        while (t) {
+            Timer *next = t->next;
+            if (t->due_ms <= now_ms) {
+                t->pprev = NULL;
+                fire(t, arg);
+            } else {                 // a later turn of the wheel
+                t->pprev = NULL;
+                timer_add(w, t, t->due_ms);
+            }
+            t = next;
+        }
+    }
+}
+
+// ============================= STATS =============================
+// tick latency: how long after its due ms a gravity timer ran, 10 us buckets
+#define LAT_BUCKETS 2000
+
+typedef struct {
+    atomic_long sessions, accepted, closed;
+    atomic_long msgs_in, states_out, ticks, cpu_us;
+    atomic_long lat[LAT_BUCKETS + 1];
+    atomic_long lat_max;
+} Stats;
+
+// single writer per counter, so a plain load + store is enough
+static void bump(atomic_long *c, long v) {
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + v, memory_order_relaxed);
+}
+
+// ============================= SESSIONS ==========================
+typedef struct Worker Worker;
+
+typedef struct {
+    Timer timer;                     // first, so a Timer * is its Session *
+    Worker *w;
+    int fd;
+    int started;
+    Game g;
+    MsgHello hello;
+    uint32_t games;
+    uint32_t player;                 // for the high-score log
+    uint16_t seq;                    // last input applied
+    long synced_ms;                  // game time is caught up to here
+    int in_len, out_len, out_off;
+    int state_pending;               // a STATE is owed once out[] drains
+    uint8_t in[256];
+    uint8_t out[2 * MSG_STATE_MAX];
+} Session;
+
+struct Worker {
+    int id;
+    int ep, tick_fd, wake_fd;
+    pthread_t tid;
+    Wheel wheel;
+    pthread_mutex_t lock;            // guards incoming[]
+    int *incoming, n_incoming, cap_incoming;
+    uint32_t sessions_made;
+    ScoreWriter sw;
+    long scores_flushed_us;
+    long live;                       // sessions with a game going
+    Stats st;
+};
+
+static Worker *workers;
+static ScoreBoard *scores;
+static MetSegment *metrics;
+static atomic_int quit;
+
+static void session_close(Session *s) {
+    if (s->started) {
+        if (met_here && !s->g.over) met_game_end(met_here, s->g.level);  // abandoned
+        if (met_here) met_set(met_here, MET_LIVE, (uint64_t)--s->w->live);
+    }
+    timer_del(&s->timer);
+    close(s->fd);                    // also drops it from the epoll set
+    bump(&s->w->st.sessions, -1);
+    bump(&s->w->st.closed, 1);
+    free(s);
+}
+
+static void session_want_write(Session *s, int on) {
+    struct epoll_event ev = { .events = EPOLLIN | (on ? EPOLLOUT : 0), .data.ptr = s };
+    epoll_ctl(s->w->ep, EPOLL_CTL_MOD, s->fd, &ev);
+}
+
+// 0 if the connection failed
+static int session_flush(Session *s) {
+    while (s->out_off < s->out_len) {
+        ssize_t k = send(s->fd, s->out + s->out_off, (size_t)(s->out_len - s->out_off), MSG_NOSIGNAL);
+        if (k < 0 && errno == EAGAIN) { session_want_write(s, 1); return 1; }
+        if (k <= 0) return 0;
+        s->out_off += (int)k;
+    }
+    s->out_off = s->out_len = 0;
+    return 1;
+}
+
+// a slow reader gets the newest state once it catches up, not a backlog
+static int session_send_state(Session *s) {
+    if (s->out_len) { s->state_pending = 1; return 1; }
+    MsgState m;
+    msg_state_from_game(&m, &s->g, s->seq, s->games);
+    s->out_len = msg_put_state(s->out, &m);
+    bump(&s->w->st.states_out, 1);
+    return session_flush(s);
+}
+
+static void session_start(Session *s, long now_ms) {
+    if (!s->started) {
+        s->w->live++;
+        if (met_here) met_set(met_here, MET_LIVE, (uint64_t)s->w->live);
+    } else if (met_here && !s->g.over) {
+        met_game_end(met_here, s->g.level);           // a new HELLO drops the game
+    }
+    Rng r;
+    rng_init(&r, s->hello.seed, s->games);   // game k of a session: stream k
+    game_init(&s->g, s->hello.rules ? RULES_10X20 : RULES_8X8, r, s->hello.level);
+    if (s->hello.policy) {
+        s->g.piece_policy = PIECES_BAG;
+        game_reset(&s->g, r);
+    }
+    s->started = 1;
+    s->synced_ms = now_ms;
+}
+
+// catch the game up to now_ms; returns whether the board or piece changed
+static int session_sync(Session *s, long now_ms) {
+    if (now_ms <= s->synced_ms) return 0;
+    int py = s->g.py;
+    long pieces = s->g.pieces;
+    game_tick(&s->g, (int)(now_ms - s->synced_ms));
+    s->synced_ms = now_ms;
+    return s->g.py != py || s->g.pieces != pieces || s->g.over;
+}
+
+// ends a finished game (its last STATE goes out first) and re-arms gravity
+static int session_settle(Session *s) {
+    if (s->g.over) {
+        if (scores) {
+            ScoreRec r;
+            score_from_game(&r, &s->g, s->player, s->hello.seed);
+            score_submit(&s->w->sw, &r);
+        }
+        if (met_here) met_game_end(met_here, s->g.level);
+        if (!session_send_state(s)) return 0;
+        s->games++;
+        session_start(s, s->synced_ms);
+        if (!session_send_state(s)) return 0;
+    }
+    long due = game_due_ms(&s->g);
+    timer_add(&s->w->wheel, &s->timer, s->synced_ms + (due > 0 ? due : 1));
+    return 1;
+}
+
+static void on_gravity(Timer *t, void *arg) {
+    Session *s = (Session *)t;
+    long now = *(long *)arg, now_ms = now / 1000;
+    Stats *st = &s->w->st;
+    long late = now - t->due_ms * 1000;
+    if (late < 0) late = 0;
+    bump(&st->lat[late / 10 < LAT_BUCKETS ? late / 10 : LAT_BUCKETS], 1);
+    if (late > atomic_load_explicit(&st->lat_max, memory_order_relaxed))
+        atomic_store_explicit(&st->lat_max, late, memory_order_relaxed);
+    bump(&st->ticks, 1);
+
+    int changed = session_sync(s, now_ms);
+    if (changed && !s->g.over && !session_send_state(s)) { session_close(s); return; }
+    if (!session_settle(s)) session_close(s);
+}
+
+// returns 0 to close the session
+static int session_read(Session *s, long now_ms) {
+    for (;;) {
+        size_t room = sizeof s->in - (size_t)s->in_len;
+        ssize_t k = recv(s->fd, s->in + s->in_len, room, 0);
+        if (k == 0) return 0;
+        if (k < 0) return errno == EAGAIN;
+        s->in_len += (int)k;
+
+        int off = 0, inputs = 0;
+        while (s->in_len - off >= 2) {
+            const uint8_t *p = s->in + off;
+            if (p[1] < 2) return 0;                       // cannot make progress
+            if (s->in_len - off < p[1]) break;
+            bump(&s->w->st.msgs_in, 1);
+            if (p[0] == MSG_HELLO && p[1] == MSG_HELLO_LEN) {
+                msg_get_hello(p, &s->hello);
+                if (s->hello.level > 29) s->hello.level = 29;
+                s->games = 0;
+                s->seq = 0;
+                session_start(s, now_ms);
+                ++inputs;
+            } else if (p[0] == MSG_INPUT && p[1] == MSG_INPUT_LEN && s->started) {
+                MsgInput in;
+                msg_get_input(p, &in);
+                session_sync(s, now_ms);
+                if (!s->g.over) game_apply(&s->g, in.action);
+                s->seq = in.seq;
+                ++inputs;
+            }
+            off += p[1];
+        }
+        memmove(s->in, s->in + off, (size_t)(s->in_len - off));
+        s->in_len -= off;
+
+        // one STATE for everything read in this batch
+        if (inputs) {
+            if (!s->g.over && !session_send_state(s)) return 0;
+            if (!session_settle(s)) return 0;
+        }
+        if ((size_t)k < room) return 1;                   // drained
+    }
+}
+
+// ============================= WORKERS ===========================
+static void worker_adopt(Worker *w) {
+    int fds[64], n;
+    do {
+        pthread_mutex_lock(&w->lock);
+        n = w->n_incoming < 64 ? w->n_incoming : 64;
+        w->n_incoming -= n;
+        memcpy(fds, w->incoming + w->n_incoming, (size_t)n * sizeof *fds);
+        pthread_mutex_unlock(&w->lock);
+
+        for (int i = 0; i < n; ++i) {
+            Session *s = calloc(1, sizeof *s);
+            if (!s) { close(fds[i]); continue; }
+            s->w = w;
+            s->fd = fds[i];
+            s->player = w->sessions_made++ * (uint32_t)opt_workers + (uint32_t)w->id;
+            struct epoll_event ev = { .events = EPOLLIN, .data.ptr = s };
+            if (epoll_ctl(w->ep, EPOLL_CTL_ADD, s->fd, &ev) < 0) { close(s->fd); free(s); continue; }
+            bump(&w->st.sessions, 1);
+            bump(&w->st.accepted, 1);
+        }
+    } while (n == 64);
+}
+
+static void *worker_main(void *arg) {
+    Worker *w = arg;
+    if (opt_pin) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(w->id % (int)sysconf(_SC_NPROCESSORS_ONLN), &set);
+        pthread_setaffinity_np(pthread_self(), sizeof set, &set);
+    }
+    w->wheel.now_ms = now_us() / 1000;
+    if (metrics) {
+        char name[24];
+        snprintf(name, sizeof name, "worker %d", w->id);
+        met_here = met_claim(metrics, name);
+    }
+
+    struct epoll_event ev[256];
+    long cpu0 = thread_cpu_us();
+    while (!atomic_load_explicit(&quit, memory_order_relaxed)) {
+        int n = epoll_wait(w->ep, ev, 256, 100);
+        long t0 = now_ns(), now = t0 / 1000;
+        for (int i = 0; i < n; ++i) {
+            void *p = ev[i].data.ptr;
+            if (p == &w->tick_fd) {
+                uint64_t expirations;
+                if (read(w->tick_fd, &expirations, sizeof expirations) < 0) { /* spurious */ }
+            } else if (p == &w->wake_fd) {
+                uint64_t count;
+                if (read(w->wake_fd, &count, sizeof count) < 0) { /* spurious */ }
+                worker_adopt(w);
+            } else {
+                Session *s = p;
+                int ok = 1;
+                if (ev[i].events & (EPOLLERR | EPOLLHUP)) ok = 0;
+                if (ok && (ev[i].events & EPOLLOUT)) {
+                    ok = session_flush(s);
+                    if (ok && !s->out_len) {
+                        session_want_write(s, 0);
+                        if (s->state_pending) { s->state_pending = 0; ok = session_send_state(s); }
+                    }
+                }
+                if (ok && (ev[i].events & EPOLLIN)) ok = session_read(s, now / 1000);
+                if (!ok) session_close(s);
+            }
+        }
+        wheel_turn(&w->wheel, now / 1000, on_gravity, &now);
+        if (scores && w->sw.n && now - w->scores_flushed_us >= 1000000) {   // at least once a second
+            score_writer_flush(&w->sw);
+            w->scores_flushed_us = now;
+        }
+        long cpu = thread_cpu_us();
+        bump(&w->st.cpu_us, cpu - cpu0);
+        cpu0 = cpu;
+        if (met_here) met_frame(met_here, now_ns() - t0);
+    }
+    if (scores) score_writer_flush(&w->sw);
+    return NULL;
+}
+
+static void worker_init(Worker *w, int id) {
+    w->id = id;
+    w->ep = epoll_create1(0);
+    w->tick_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    w->wake_fd = eventfd(0, EFD_NONBLOCK);
+    if (w->ep < 0 || w->tick_fd < 0 || w->wake_fd < 0) { perror("epoll/timerfd/eventfd"); exit(1); }
+    struct itimerspec its = { .it_interval = { 0, 1000000 }, .it_value = { 0, 1000000 } };
+    timerfd_settime(w->tick_fd, 0, &its, NULL);
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = &w->tick_fd };
+    epoll_ctl(w->ep, EPOLL_CTL_ADD, w->tick_fd, &ev);
+    ev.data.ptr = &w->wake_fd;
+    epoll_ctl(w->ep, EPOLL_CTL_ADD, w->wake_fd, &ev);
+    pthread_mutex_init(&w->lock, NULL);
+}
+
+static void worker_give(Worker *w, int fd) {
+    pthread_mutex_lock(&w->lock);
+    if (w->n_incoming == w->cap_incoming) {
+        w->cap_incoming = w->cap_incoming ? 2 * w->cap_incoming : 64;
+        w->incoming = realloc(w->incoming, (size_t)w->cap_incoming * sizeof *w->incoming);
+        if (!w->incoming) { perror("realloc"); exit(1); }
+    }
+    w->incoming[w->n_incoming++] = fd;
+    pthread_mutex_unlock(&w->lock);
+    uint64_t one = 1;
+    if (write(w->wake_fd, &one, sizeof one) < 0) { /* counter saturated: already awake */ }
+}
+
+// ============================= LISTENING =========================
+static int listen_tcp(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0), one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+    struct sockaddr_in a = { .sin_family = AF_INET, .sin_port = htons((uint16_t)port),
+                             .sin_addr.s_addr = htonl(INADDR_ANY) };
+    if (bind(fd, (struct sockaddr *)&a, sizeof a) < 0 || listen(fd, 4096) < 0) { perror("tcp"); exit(1); }
+    return fd;
+}
+
+static int listen_unix(const char *path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    struct sockaddr_un a = { .sun_family = AF_UNIX };
+    snprintf(a.sun_path, sizeof a.sun_path, "%s", path);
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&a, sizeof a) < 0 || listen(fd, 4096) < 0) { perror("unix"); exit(1); }
+    return fd;
+}
+
+// ============================= REPORT ============================
+static long lat_percentile(const long *h, long total, double q) {
+    if (total <= 0) return 0;
+    long want = (long)(q * total), seen = 0;
+    for (int b = 0; b <= LAT_BUCKETS; ++b)
+        if ((seen += h[b]) > want) return b * 10L;
+    return LAT_BUCKETS * 10L;
+}
+
+// everything since the previous report
+static void report(long dt_us) {
+    static long prev_in, prev_out, prev_ticks, *prev_cpu, prev_lat[LAT_BUCKETS + 1];
+    if (!prev_cpu) prev_cpu = calloc((size_t)opt_workers, sizeof *prev_cpu);
+
+    long sessions = 0, in = 0, out = 0, ticks = 0, max = 0, cpu_total = 0;
+    static long lat[LAT_BUCKETS + 1];
+    char per[256] = ""; int np = 0;
+    memset(lat, 0, sizeof lat);
+    for (int i = 0; i < opt_workers; ++i) {
+        Stats *st = &workers[i].st;
+        long ns = atomic_load(&st->sessions), cpu = atomic_load(&st->cpu_us);
+        sessions += ns;
+        in += atomic_load(&st->msgs_in);
+        out += atomic_load(&st->states_out);
+        ticks += atomic_load(&st->ticks);
+        for (int b = 0; b <= LAT_BUCKETS; ++b) lat[b] += atomic_load(&st->lat[b]);
+        long m = atomic_exchange(&st->lat_max, 0);
+        if (m > max) max = m;
+        cpu_total += cpu - prev_cpu[i];
+        if (np < (int)sizeof per - 32)
+            np += snprintf(per + np, sizeof per - (size_t)np, " %ld@%.0f%%",
+                           ns, 100.0 * (cpu - prev_cpu[i]) / dt_us);
+        prev_cpu[i] = cpu;
+    }
+    long n_lat = 0;
+    for (int b = 0; b <= LAT_BUCKETS; ++b) {
+        long d = lat[b] - prev_lat[b];
+        prev_lat[b] = lat[b];
+        lat[b] = d;
+        n_lat += d;
+    }
+    double secs = dt_us / 1e6, busy = (double)cpu_total / dt_us;   // cores in use
+    fprintf(stderr, "sessions %ld (per worker:%s)  in %.0f/s  out %.0f/s  ticks %.0f/s  "
+                    "tick late p50 %ld us p99 %ld us max %ld us  ~%.0f sessions/core\n",
+            sessions, per, (in - prev_in) / secs, (out - prev_out) / secs,
+            (ticks - prev_ticks) / secs,
+            lat_percentile(lat, n_lat, 0.50), lat_percentile(lat, n_lat, 0.99), max,
+            busy > 0.01 ? sessions / busy : 0.0);
+    prev_in = in; prev_out = out; prev_ticks = ticks;
+}
+
+// ================================ MAIN ===========================
+static void on_int(int sig) { (void)sig; atomic_store(&quit, 1); }
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-p tcp_port] [-u unix_path] [-w workers] [-a pin workers]"
+                    " [-s stats_seconds] [-H score_log] [-M metrics_file]\n", argv0);
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "p:u:w:as:H:M:")) != -1) {
+        switch (opt) {
+            case 'p': opt_port = atoi(optarg); break;
+            case 'u': opt_unix = optarg; break;
+            case 'w': opt_workers = atoi(optarg); break;
+            case 'a': opt_pin = 1; break;
+            case 's': opt_stats_s = atoi(optarg); break;
+            case 'H': opt_scores = optarg; break;
+            case 'M': opt_metrics = optarg; break;
+            default: usage(argv[0]);
+        }
+    }
+    if ((!opt_port && !opt_unix) || opt_workers < 1 || opt_stats_s < 1) usage(argv[0]);
+
+    struct rlimit rl;                // one descriptor per session
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0) { rl.rlim_cur = rl.rlim_max; setrlimit(RLIMIT_NOFILE, &rl); }
+    signal(SIGINT, on_int);
+    signal(SIGTERM, on_int);
+    signal(SIGPIPE, SIG_IGN);
+
+    struct pollfd lfd[2];
+    int nl = 0;
+    if (opt_port) lfd[nl++] = (struct pollfd){ .fd = listen_tcp(opt_port), .events = POLLIN };
+    if (opt_unix) lfd[nl++] = (struct pollfd){ .fd = listen_unix(opt_unix), .events = POLLIN };
+
+    if (opt_scores) {
+        long replayed;
+        scores = scores_open(opt_scores, &replayed);
+        if (!scores) { fprintf(stderr, "%s: %s\n", opt_scores, strerror(errno)); return 1; }
+        fprintf(stderr, "server: %ld games in %s\n", replayed, opt_scores);
+        if (scores->damaged) fprintf(stderr, "server: %s: %ld damaged bytes skipped\n", opt_scores, scores->damaged);
+    }
+    if (opt_metrics) {
+        metrics = met_create(opt_metrics);
+        if (!metrics) { fprintf(stderr, "%s: %s\n", opt_metrics, strerror(errno)); return 1; }
+    }
+    workers = calloc((size_t)opt_workers, sizeof *workers);
+    if (!workers) { perror("calloc"); return 1; }
+    for (int i = 0; i < opt_workers; ++i) score_writer_init(&workers[i].sw, scores);
+    for (int i = 0; i < opt_workers; ++i) worker_init(&workers[i], i);
+    for (int i = 0; i < opt_workers; ++i) pthread_create(&workers[i].tid, NULL, worker_main, &workers[i]);
+    fprintf(stderr, "server: %d workers, tcp %d, unix %s\n", opt_workers, opt_port,
+            opt_unix ? opt_unix : "-");
+
+    long last = now_us();
+    int next_worker = 0;
+    while (!atomic_load(&quit)) {
+        if (poll(lfd, (nfds_t)nl, 200) > 0)
+            for (int i = 0; i < nl; ++i) {
+                if (!(lfd[i].revents & POLLIN)) continue;
+                int fd;
+                while ((fd = accept4(lfd[i].fd, NULL, NULL, SOCK_NONBLOCK)) >= 0) {
+                    int one = 1;
+                    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one); // fails on UNIX: fine
+                    worker_give(&workers[next_worker], fd);
+                    next_worker = (next_worker + 1) % opt_workers;
+                }
+            }
+        long t = now_us();
+        if (t - last >= opt_stats_s * 1000000L) { report(t - last); last = t; }
+    }
+    report(now_us() - last);
+    long recorded = 0;
+    for (int i = 0; i < opt_workers; ++i) {
+        pthread_join(workers[i].tid, NULL);
+        recorded += workers[i].sw.submitted;
+    }
+    if (scores) {
+        fprintf(stderr, "server: %ld games recorded in %s\n", recorded, opt_scores);
+        scores_close(scores);
+    }
+    met_close(metrics);
+    if (opt_unix) unlink(opt_unix);
+    return 0;
+}
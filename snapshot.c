@@ -0,0 +1,216 @@
+// snapshot.c — save records of an engine Game (see snapshot.h)
+// build: linked into the tools that suspend games, e.g.
+//        gcc -O2 -std=c11 snaptool.c snapshot.c engine.c bot.c -o snaptool
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "snapshot.h"
+
+// ============================= Records ===========================
+// FNV-1a over the record minus the check field, a 64-bit word at a time
+static uint64_t record_check(const GameSnap *s) {
+    const uint8_t *p = (const uint8_t *)s;
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < sizeof *s; i += 8) {
+        if (i == offsetof(GameSnap, check)) continue;
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        h = (h ^ w) * 0x100000001B3ull;
+    }
+    return h;
+}
+
+void snap_save(GameSnap *s, const Game *g) {
+    memset(s, 0, sizeof *s);
+    s->magic = SNAP_MAGIC;
+    s->version = SNAP_VERSION;
+    s->rules = (uint8_t)g->rules;
+    s->flags = (uint8_t)((g->over ? SNAP_OVER : 0) | (g->soft_drop_enabled ? SNAP_SOFT_DROP : 0) |
+                         (g->gravity_fixed ? SNAP_GRAVITY_FIXED : 0) | (g->versus ? SNAP_VERSUS : 0) |
+                         (g->piece_policy == PIECES_BAG ? SNAP_POLICY_BAG : 0) |
+                         (g->queue.policy == PIECES_BAG ? SNAP_QUEUE_BAG : 0));
+
+    s->key[0] = g->rng.key[0]; s->key[1] = g->rng.key[1];
+    s->rng_stream = g->rng.stream;                 s->rng_index = g->rng.index;
+    s->queue_stream = g->queue.rng.stream;         s->queue_index = g->queue.rng.index;
+    s->garbage_stream = g->garbage_rng.stream;     s->garbage_index = g->garbage_rng.index;
+
+    s->fall_acc = g->fall_acc; s->lock_timer_ms = g->lock_timer_ms;
+    s->pieces = g->pieces; s->time_ms = g->time_ms;
+    s->score = g->score; s->lines_total = g->lines_total;
+    s->next_level_lines = g->next_level_lines;
+    s->fall_interval_ms = g->fall_interval_ms; s->lock_delay_ms = g->lock_delay_ms;
+    s->attack_out = g->attack_out;
+    s->mask = g->mask;                             // kept after a top-out too (game_checksum reads it)
+    s->level = (uint16_t)g->level;
+    s->fall_rows = (int16_t)g->fall_rows;
+    s->start_level = (uint8_t)g->start_level;
+    s->speed_curve = (uint8_t)g->speed_curve;
+    s->piece = (int8_t)g->piece;
+    s->px = (int8_t)g->px;
+    s->py = (int8_t)g->py;
+
+    s->queue_count = g->queue.count;
+    for (int i = 0; i < g->queue.count; ++i)
+        s->queue[i / 2] |= (uint8_t)(pieces_peek(&g->queue, i) << (i & 1) * 4);
+    s->garbage_count = g->garbage_count;
+    for (int i = 0; i < g->garbage_count; ++i) {
+        int k = (g->garbage_head + i) % EN_GARBAGE_Q;
+        s->garbage_lines[i] = g->garbage_lines[k];
+        s->garbage_hole[i] = g->garbage_hole[k];
+    }
+    uint32_t acc = 0;                              // rows into a bit stream, w bits each
+    int bits = 0, out = 0;
+    for (int r = 0; r < g->h; ++r) {
+        acc |= (uint32_t)g->rows[r] << bits;
+        for (bits += g->w; bits >= 8; bits -= 8, acc >>= 8) s->rows[out++] = (uint8_t)acc;
+    }
+    if (bits) s->rows[out] = (uint8_t)acc;
+
+    s->check = record_check(s);
+}
+
+static Rng stream_at(const uint32_t key[2], uint64_t stream, uint64_t index) {
+    Rng r;
+    rng_init(&r, (uint64_t)key[1] << 32 | key[0], stream);
+    r.index = index;                               // cached = 0: the block is recomputed on use
+    return r;
+}
+
+int snap_restore(Game *g, const GameSnap *s) {
+    if (s->magic != SNAP_MAGIC || s->version != SNAP_VERSION || s->check != record_check(s)) return 0;
+    if (s->rules > RULES_10X20 || s->queue_count > PIECE_QUEUE_LEN || s->garbage_count > EN_GARBAGE_Q ||
+        s->piece < -1 || s->piece >= game_shape_count((Rules)s->rules) || s->speed_curve >= SPEED_CURVES)
+        return 0;
+    if (s->fall_interval_ms <= 0 || s->fall_rows <= 0 || s->start_level >= SPEED_LEVELS || s->level < s->start_level ||
+        s->next_level_lines != speed_next_level_lines(s->speed_curve, s->start_level, s->level))
+        return 0;                                   // levels past the table are fine, the engine keeps its last entry
+    for (int i = 0; i < s->garbage_count; ++i)
+        if (s->garbage_hole[i] >= (s->rules == RULES_8X8 ? 8 : 10)) return 0;
+
+    Game t;
+    memset(&t, 0, sizeof t);
+    t.rules = (Rules)s->rules;
+    t.w = t.rules == RULES_8X8 ? 8 : 10;
+    t.h = t.rules == RULES_8X8 ? 8 : 20;
+    t.full = (uint16_t)((1u << t.w) - 1);
+    t.over = !!(s->flags & SNAP_OVER);
+    t.soft_drop_enabled = !!(s->flags & SNAP_SOFT_DROP);
+    t.gravity_fixed = !!(s->flags & SNAP_GRAVITY_FIXED);
+    t.versus = !!(s->flags & SNAP_VERSUS);
+    t.piece_policy = s->flags & SNAP_POLICY_BAG ? PIECES_BAG : PIECES_UNIFORM;
+
+    t.rng = stream_at(s->key, s->rng_stream, s->rng_index);
+    t.garbage_rng = stream_at(s->key, s->garbage_stream, s->garbage_index);
+    t.queue.rng = stream_at(s->key, s->queue_stream, s->queue_index);
+    t.queue.kinds = (uint8_t)game_shape_count(t.rules);
+    t.queue.policy = s->flags & SNAP_QUEUE_BAG ? PIECES_BAG : PIECES_UNIFORM;
+    t.queue.head = 0;
+    t.queue.count = s->queue_count;
+    for (int i = 0; i < s->queue_count; ++i) {
+        t.queue.q[i] = (uint8_t)(s->queue[i / 2] >> (i & 1) * 4 & 0xF);
+        if (t.queue.q[i] >= t.queue.kinds) return 0;
+    }
+
+    t.fall_acc = s->fall_acc; t.lock_timer_ms = s->lock_timer_ms;
+    t.pieces = s->pieces; t.time_ms = s->time_ms;
+    t.score = s->score; t.lines_total = s->lines_total;
+    t.next_level_lines = s->next_level_lines;
+    t.fall_interval_ms = s->fall_interval_ms; t.lock_delay_ms = s->lock_delay_ms;
+    t.attack_out = s->attack_out;
+    t.level = s->level;
+    t.fall_rows = s->fall_rows;
+    t.start_level = s->start_level;
+    t.speed_curve = s->speed_curve;
+
+    t.garbage_head = 0;
+    t.garbage_count = s->garbage_count;
+    t.garbage_pending = 0;
+    for (int i = 0; i < s->garbage_count; ++i) {
+        t.garbage_lines[i] = s->garbage_lines[i];
+        t.garbage_hole[i] = s->garbage_hole[i];
+        t.garbage_pending += s->garbage_lines[i];
+    }
+
+    uint32_t acc = 0;
+    int bits = 0, in = 0;
+    for (int r = 0; r < t.h; ++r) {
+        for (; bits < t.w; bits += 8) acc |= (uint32_t)s->rows[in++] << bits;
+        t.rows[r] = (uint16_t)(acc & t.full);
+        acc >>= t.w;
+        bits -= t.w;
+    }
+    for (int c = 0; c < t.w; ++c) {                // skyline from the cells
+        int r = 0;
+        while (r < t.h && !(t.rows[r] >> c & 1)) ++r;
+        t.heights[c] = (uint8_t)(t.h - r);
+    }
+
+    t.piece = s->piece;
+    t.mask = s->mask; t.px = s->px; t.py = s->py;
+    if (t.piece >= 0) {                             // a finished game skips the collisions, not the walls
+        if (!game_is_rotation(t.rules, t.piece, t.mask) || !game_in_bounds(&t, t.mask, t.px, t.py)) return 0;
+        if (!t.over && !game_fits(&t, t.mask, t.px, t.py)) return 0;
+        t.ghost_py = game_drop_row(&t);
+    }
+    *g = t;
+    return 1;
+}
+
+// ============================== Files ============================
+int snap_write(const char *path, const GameSnap *s, size_t n) {
+    char tmp[4096];
+    if (snprintf(tmp, sizeof tmp, "%s.tmp", path) >= (int)sizeof tmp) { errno = ENAMETOOLONG; return -1; }
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+    SnapFileHeader h;
+    memset(&h, 0, sizeof h);
+    h.magic = SNAP_FILE_MAGIC;
+    h.version = SNAP_VERSION;
+    h.record_size = sizeof *s;
+    h.count = n;
+    const uint8_t *parts[2] = { (const uint8_t *)&h, (const uint8_t *)s };
+    size_t sizes[2] = { sizeof h, n * sizeof *s };
+    for (int i = 0; i < 2; ++i)
+        for (size_t done = 0; done < sizes[i]; ) {
+            ssize_t w = write(fd, parts[i] + done, sizes[i] - done);
+            if (w < 0 && errno == EINTR) continue;
+            if (w < 0) { int e = errno; close(fd); unlink(tmp); errno = e; return -1; }
+            done += (size_t)w;
+        }
+    if (fsync(fd) < 0 || close(fd) < 0) { int e = errno; unlink(tmp); errno = e; return -1; }
+    return rename(tmp, path);
+}
+
+int snap_map(SnapMap *m, const char *path) {
+    memset(m, 0, sizeof *m);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(SnapFileHeader)) { close(fd); errno = EINVAL; return -1; }
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return -1;
+    const SnapFileHeader *h = base;
+    if (h->magic != SNAP_FILE_MAGIC || h->version != SNAP_VERSION || h->record_size != sizeof(GameSnap) ||
+        h->count > ((size_t)st.st_size - sizeof *h) / sizeof(GameSnap)) {
+        munmap(base, (size_t)st.st_size);
+        errno = EINVAL;
+        return -1;
+    }
+    m->base = base;
+    m->size = (size_t)st.st_size;
+    m->recs = (const GameSnap *)((const uint8_t *)base + sizeof *h);
+    m->count = (size_t)h->count;
+    return 0;
+}
+
+void snap_unmap(SnapMap *m) {
+    if (m->base) munmap(m->base, m->size);
+    memset(m, 0, sizeof *m);
+}
@@ -0,0 +1,88 @@
+// snapshot.h — versioned fixed-size save records of an engine Game
+// A Game is already a plain struct (engine.h), but its layout follows the
+// compiler and the engine's needs of the day. A GameSnap is the stable
+// on-disk form: 192 bytes of fixed-width fields, the settled cells packed
+// w bits per row, the random streams as seed key + stream + position, and
+// an FNV-1a checksum over the rest. What can be recomputed (skyline, ghost,
+// board size, garbage total, RNG block cache) is left out.
+//
+// A snapshot file is a 64-byte header and then GameSnap records back to
+// back, so it can be mmap'ed and the records used in place: restoring a
+// session is snap_restore() on its record, with no parsing and no copies of
+// the file. Fields are little-endian; snap_map() refuses a file whose magic
+// reads back wrong on this host.
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "engine.h"
+
+#define SNAP_MAGIC      0x50414E53u  // "SNAP"
+#define SNAP_FILE_MAGIC 0x53504E53u  // "SNPS"
+#define SNAP_VERSION    1
+#define SNAP_ROW_BYTES  ((EN_MAX_W * EN_MAX_H + 7) / 8)
+
+// flags
+#define SNAP_OVER          0x01
+#define SNAP_SOFT_DROP     0x02
+#define SNAP_GRAVITY_FIXED 0x04
+#define SNAP_VERSUS        0x08
+#define SNAP_POLICY_BAG    0x10      // piece_policy, for the next game_reset()
+#define SNAP_QUEUE_BAG     0x20      // policy of the queue in play
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t rules, flags;
+    uint64_t check;                  // FNV-1a of every other byte
+    // random streams, all under the same key (rng_split keeps the key)
+    uint64_t rng_stream, rng_index;
+    uint64_t queue_stream, queue_index;
+    uint64_t garbage_stream, garbage_index;
+    int64_t fall_acc, lock_timer_ms, pieces, time_ms;
+    uint32_t key[2];
+    int32_t score, lines_total, next_level_lines, fall_interval_ms, lock_delay_ms, attack_out;
+    uint16_t mask, level;
+    int16_t fall_rows;
+    uint8_t start_level, speed_curve;
+    int8_t piece, px, py;
+    uint8_t queue_count, garbage_count;
+    uint8_t queue[PIECE_QUEUE_LEN / 2];          // upcoming pieces, 4 bits each, next first
+    uint8_t garbage_lines[EN_GARBAGE_Q], garbage_hole[EN_GARBAGE_Q];  // oldest first
+    uint8_t rows[SNAP_ROW_BYTES];                // bit r*w + c = cell (r, c)
+} GameSnap;
+
+_Static_assert(sizeof(GameSnap) == 192, "GameSnap layout changed: bump SNAP_VERSION");  // and keep it a multiple of 8 (record_check)
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;            // sizeof(GameSnap)
+    uint64_t count;
+    uint8_t reserved[48];
+} SnapFileHeader;
+
+_Static_assert(sizeof(SnapFileHeader) == 64, "SnapFileHeader must stay 64 bytes");
+
+void snap_save(GameSnap *s, const Game *g);
+// 0 if the record is damaged, from another version, or out of range;
+// g is only written when the record is good
+int snap_restore(Game *g, const GameSnap *s);
+
+// write n records to path (through a temporary file and a rename, so a
+// crash leaves the old file); -1 with errno set on failure
+int snap_write(const char *path, const GameSnap *s, size_t n);
+
+typedef struct {
+    void *base;
+    size_t size;
+    const GameSnap *recs;
+    size_t count;
+} SnapMap;
+
+// map a snapshot file read-only; -1 if it cannot be opened or is not one
+int snap_map(SnapMap *m, const char *path);
+void snap_unmap(SnapMap *m);
+
+#endif
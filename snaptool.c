@@ -0,0 +1,158 @@
+// snaptool.c — suspend many games to a snapshot file and bring them back
+// build: gcc -O2 -std=c11 snaptool.c snapshot.c engine.c bot.c -o snaptool
+// run:   ./snaptool -n 10000 -o games.snap      (play, save, reload, verify)
+//        ./snaptool -l games.snap               (time a cold restore only)
+//
+// Each game is played by the bot for a different stretch of time, with a
+// mix of rules, piece policies and versus garbage so the records cover
+// the whole state. After the file is written it is mapped back, every
+// record is restored and checked against the game it came from, and both
+// copies then play on with the same inputs to show they stay identical.
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include "engine.h"
+#include "bot.h"
+#include "snapshot.h"
+
+// ============================= TIMING ============================
+static long now_ns(void) {
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)(ts.tv_sec*1000000000LL + ts.tv_nsec);
+}
+
+// ============================= OPTIONS ===========================
+static long opt_games = 10000;
+static const char *opt_out = "games.snap";
+static const char *opt_load = NULL;
+static int opt_bot_ms = 50;
+static int opt_max_s = 120;          // game time each game is played, at most
+static int opt_after = 200;          // steps played on after restoring
+static uint64_t opt_seed = 1;
+
+// ============================= GAMES =============================
+static void play(Game *g, Bot *b, Rng *r, int steps) {
+    for (int i = 0; i < steps && !g->over; ++i) {
+        game_apply(g, bot_next_action(b, g));
+        game_tick(g, opt_bot_ms);
+        if (g->versus && rng_below(r, 8) == 0) game_receive_garbage(g, 1 + (int)rng_below(r, 3));
+        game_take_attack(g);
+    }
+}
+
+static void make_game(Game *g, long id) {
+    Rng r;
+    rng_init(&r, opt_seed, (uint64_t)id);
+    Rng play_rng = rng_split(&r, 0);
+    Rules rules = id % 4 == 3 ? RULES_8X8 : RULES_10X20;
+    game_init(g, rules, rng_split(&r, 1), (int)(id % 10));
+    g->piece_policy = id % 3 == 0 ? PIECES_BAG : PIECES_UNIFORM;  // both read by game_reset()
+    if (rules == RULES_10X20) g->speed_curve = (int)(id / 4 % SPEED_CURVES);
+    game_reset(g, rng_split(&r, 1));
+    g->versus = id % 2 == 0;
+    if (id % 5 == 0) game_set_gravity(g, 1, 100);
+    Bot b;
+    bot_init(&b, &BOT_DEFAULT_WEIGHTS);
+    play(g, &b, &play_rng, (int)rng_below(&play_rng, (uint32_t)(opt_max_s * 1000 / opt_bot_ms) + 1));
+}
+
+// the fields snap_restore() recomputes, on top of game_checksum()
+static int same_game(const Game *a, const Game *b) {
+    if (game_checksum(a) != game_checksum(b)) return 0;
+    // the skyline is rebuilt from the cells; once garbage has pushed a game
+    // over the top the engine stops keeping it, so only live games compare
+    if (!a->over && memcmp(a->heights, b->heights, sizeof a->heights) != 0) return 0;
+    if (a->piece >= 0 && a->ghost_py != b->ghost_py) return 0;
+    return a->level == b->level && a->fall_rows == b->fall_rows &&
+           a->fall_interval_ms == b->fall_interval_ms && a->lock_delay_ms == b->lock_delay_ms &&
+           a->next_level_lines == b->next_level_lines && a->versus == b->versus &&
+           a->piece_policy == b->piece_policy && a->pieces == b->pieces;
+}
+
+// ============================= LOADING ===========================
+// map the file and restore every record; returns the games, NULL on error
+static Game *load(const char *path, size_t *n, long *bad) {
+    long t0 = now_ns();
+    SnapMap m;
+    if (snap_map(&m, path) < 0) { fprintf(stderr, "%s: %s\n", path, strerror(errno)); return NULL; }
+    long t1 = now_ns();
+    Game *games = malloc((m.count ? m.count : 1) * sizeof *games);
+    if (!games) { perror("malloc"); exit(1); }
+    *bad = 0;
+    for (size_t i = 0; i < m.count; ++i)
+        if (!snap_restore(&games[i], &m.recs[i])) (*bad)++;
+    long t2 = now_ns();
+    *n = m.count;
+    printf("restored %zu games from %s (%.1f KB) in %.2f ms: map %.3f ms, %.0f ns per game, %ld bad\n",
+           m.count, path, m.size / 1024.0, (t2 - t0) / 1e6, (t1 - t0) / 1e6,
+           m.count ? (double)(t2 - t1) / m.count : 0.0, *bad);
+    snap_unmap(&m);
+    return games;
+}
+
+// ================================ MAIN ===========================
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-n games] [-o file] [-b bot_ms] [-T max_s] [-a after_steps] [-s seed]\n"
+                    "       %s -l file\n", argv0, argv0);
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "n:o:l:b:T:a:s:")) != -1) {
+        switch (opt) {
+            case 'n': opt_games = atol(optarg); break;
+            case 'o': opt_out = optarg; break;
+            case 'l': opt_load = optarg; break;
+            case 'b': opt_bot_ms = atoi(optarg); break;
+            case 'T': opt_max_s = atoi(optarg); break;
+            case 'a': opt_after = atoi(optarg); break;
+            case 's': opt_seed = strtoull(optarg, NULL, 10); break;
+            default: usage(argv[0]);
+        }
+    }
+    if (opt_games < 1 || opt_bot_ms < 1 || opt_max_s < 0 || opt_after < 0) usage(argv[0]);
+
+    size_t n;
+    long bad;
+    if (opt_load) return load(opt_load, &n, &bad) && !bad ? 0 : 1;
+
+    Game *games = malloc((size_t)opt_games * sizeof *games);
+    GameSnap *snaps = malloc((size_t)opt_games * sizeof *snaps);
+    if (!games || !snaps) { perror("malloc"); return 1; }
+    long t0 = now_ns();
+    for (long i = 0; i < opt_games; ++i) make_game(&games[i], i);
+    long t1 = now_ns();
+    for (long i = 0; i < opt_games; ++i) snap_save(&snaps[i], &games[i]);
+    long t2 = now_ns();
+    if (snap_write(opt_out, snaps, (size_t)opt_games) < 0) { fprintf(stderr, "%s: %s\n", opt_out, strerror(errno)); return 1; }
+    long t3 = now_ns();
+    printf("played %ld games in %.2f s; saved in %.0f ns per game, written in %.2f ms"
+           " (%zu bytes per game, a Game is %zu)\n",
+           opt_games, (t1 - t0) / 1e9, (double)(t2 - t1) / opt_games, (t3 - t2) / 1e6,
+           sizeof(GameSnap), sizeof(Game));
+
+    Game *back = load(opt_out, &n, &bad);
+    if (!back) return 1;
+    long diff = 0, diff_after = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (!same_game(&games[i], &back[i])) { diff++; continue; }
+        Bot b1, b2;
+        bot_init(&b1, &BOT_DEFAULT_WEIGHTS);
+        bot_init(&b2, &BOT_DEFAULT_WEIGHTS);
+        Rng r1, r2;
+        rng_init(&r1, opt_seed ^ 0xA5A5, i);
+        r2 = r1;
+        play(&games[i], &b1, &r1, opt_after);
+        play(&back[i], &b2, &r2, opt_after);
+        if (!same_game(&games[i], &back[i])) diff_after++;
+    }
+    printf("verify: %ld of %zu differ after restore, %ld differ after %d more steps\n",
+           diff, n, diff_after, opt_after);
+    free(games); free(snaps); free(back);
+    return bad || diff || diff_after ? 1 : 0;
+}
@@ -0,0 +1,381 @@
+// spectate.c — watch many headless bot games at once, tiled in the terminal
+// build: gcc -O2 -std=c11 -pthread spectate.c engine.c bot.c -o spectate
+// run:   ./spectate -n 120 -r 10x20 -t 4 -f 30
+//
+// Simulation threads own a slice of the games each and publish a small
+// snapshot per game through a seqlock, so they never wait on the renderer.
+// The renderer composes the whole grid into a character buffer, diffs it
+// against the previous refresh and sends only the changed spans in one write().
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <time.h>
+#include <signal.h>
+#include <termios.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/ioctl.h>
+#include "engine.h"
+#include "bot.h"
+
+// ============================= TIMING ============================
+static long now_ms(void) {
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)(ts.tv_sec*1000LL + ts.tv_nsec/1000000LL);
+}
+static long now_us(void) {
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)(ts.tv_sec*1000000LL + ts.tv_nsec/1000LL);
+}
+static void sleep_ms(long ms) {
+    struct timespec ts = { .tv_sec = ms / 1000, .tv_nsec = (ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+// ============================= OPTIONS ===========================
+static int opt_games = 32;
+static Rules opt_rules = RULES_10X20;
+static int opt_threads = 2;
+static int opt_fps = 30;
+static double opt_speed = 1.0;       // game ms per wall ms; 0 = as fast as possible
+static int opt_bot_ms = 50;          // game ms between bot actions
+static uint64_t opt_seed = 1;
+static PiecePolicy opt_policy = PIECES_UNIFORM;
+static int opt_grav_rows = 0, opt_grav_ms = 0; // -G rows/ms, 0 = speed curve
+static int opt_curve = -1;           // SpeedCurve, -1 = the one for the rules
+
+// ============================= SNAPSHOTS =========================
+typedef struct {
+    uint16_t settled[EN_MAX_H];
+    uint16_t active[EN_MAX_H];
+    int score, level, lines;
+    unsigned games;
+} Snap;
+
+typedef struct {
+    _Alignas(64) atomic_uint seq;   // odd while the writer is copying
+    Snap s;
+} Published;
+
+typedef struct {
+    Game g;
+    Bot bot;
+    unsigned games;
+} Slot;
+
+static Slot *slots;
+static Published *pubs;
+static atomic_long steps_total;
+static atomic_int quit;
+
+static void take_snapshot(const Game *g, unsigned games, Snap *s) {
+    memset(s->active, 0, sizeof s->active);
+    memcpy(s->settled, g->rows, sizeof s->settled);
+    if (g->piece >= 0)
+        for (int r = 0; r < 4; ++r) {
+            int gr = g->py + r;
+            unsigned nib = (g->mask >> (r * 4)) & 0xF;
+            if (nib && gr >= 0 && gr < g->h)
+                s->active[gr] = (uint16_t)(g->px >= 0 ? nib << g->px : nib >> -g->px);
+        }
+    s->score = g->score;
+    s->level = g->level;
+    s->lines = g->lines_total;
+    s->games = games;
+}
+
+static void publish(Published *p, const Snap *s) {
+    unsigned seq = atomic_load_explicit(&p->seq, memory_order_relaxed);
+    atomic_store_explicit(&p->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&p->s, s, sizeof *s);
+    atomic_store_explicit(&p->seq, seq + 2, memory_order_release);
+}
+
+// copy into *out if a consistent snapshot can be had in a few tries;
+// otherwise keep the previous copy (the writer is never held up)
+static void read_snapshot(Published *p, Snap *out) {
+    for (int tries = 0; tries < 4; ++tries) {
+        unsigned s1 = atomic_load_explicit(&p->seq, memory_order_acquire);
+        if (s1 & 1) continue;
+        Snap tmp;
+        memcpy(&tmp, &p->s, sizeof tmp);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&p->seq, memory_order_relaxed) == s1) { *out = tmp; return; }
+    }
+}
+
+// ============================= SIMULATION ========================
+// game number `games` of slot id always gets the same stream, so any game
+// seen here can be replayed on its own
+static Rng game_stream(int id, unsigned games) {
+    Rng r;
+    rng_init(&r, opt_seed, (uint64_t)id << 32 | games);
+    return r;
+}
+
+typedef struct { int first, last; } SimRange;
+
+static void step_slot(int id) {
+    Slot *sl = &slots[id];
+    game_apply(&sl->g, bot_next_action(&sl->bot, &sl->g));
+    game_tick(&sl->g, opt_bot_ms);
+    if (sl->g.over) {
+        sl->games++;
+        game_reset(&sl->g, game_stream(id, sl->games));
+    }
+}
+
+static void *sim_thread(void *arg) {
+    SimRange rg = *(SimRange *)arg;
+    long t0 = now_ms(), game_ms = 0, last_pub = -1;
+    Snap snap;
+
+    while (!atomic_load_explicit(&quit, memory_order_relaxed)) {
+        long target = opt_speed > 0 ? (long)((now_ms() - t0) * opt_speed) : game_ms + opt_bot_ms;
+        long steps = 0;
+        while (game_ms < target) {
+            for (int id = rg.first; id < rg.last; ++id) step_slot(id);
+            game_ms += opt_bot_ms;
+            steps += rg.last - rg.first;
+        }
+        if (steps && now_ms() != last_pub) {     // at most one publish per ms
+            last_pub = now_ms();
+            for (int id = rg.first; id < rg.last; ++id) {
+                take_snapshot(&slots[id].g, slots[id].games, &snap);
+                publish(&pubs[id], &snap);
+            }
+        }
+        atomic_fetch_add_explicit(&steps_total, steps, memory_order_relaxed);
+        if (opt_speed > 0) sleep_ms(1);
+    }
+    return NULL;
+}
+
+// ============================= GRID RENDER =======================
+static int term_rows = 24, term_cols = 80;
+static char *cur, *prev;             // term_rows x term_cols characters
+static char *out;                    // escape-coded diff for one refresh
+static size_t out_cap;
+static atomic_int resized = 1;
+
+static void on_winch(int sig) { (void)sig; atomic_store(&resized, 1); }
+static void on_int(int sig)   { (void)sig; atomic_store(&quit, 1); }
+
+static void grid_resize(void) {
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row && ws.ws_col) {
+        term_rows = ws.ws_row;
+        term_cols = ws.ws_col;
+    }
+    size_t n = (size_t)term_rows * term_cols;
+    cur  = realloc(cur, n);
+    prev = realloc(prev, n);
+    out_cap = n * 2 + (size_t)term_rows * 16 + 256;
+    out  = realloc(out, out_cap);
+    if (!cur || !prev || !out) { perror("realloc"); exit(1); }
+    memset(prev, 0, n);              // forces a full repaint
+}
+
+static void put_text(int row, int col, int width, const char *s) {
+    if (row < 0 || row >= term_rows) return;
+    for (int i = 0; i < width && col + i < term_cols && s[i]; ++i)
+        cur[row * term_cols + col + i] = s[i];
+}
+
+static void draw_tile(int row0, int col0, int tile_w, int id, const Snap *s, int w, int h) {
+    char buf[32];
+    snprintf(buf, sizeof buf, "#%d L%d", id, s->level);
+    put_text(row0, col0, tile_w, buf);
+    for (int r = 0; r < h; ++r) {
+        int row = row0 + 1 + r;
+        if (row >= term_rows) return;
+        buf[0] = '|';                                  // via put_text, clipped to the terminal
+        for (int c = 0; c < w; ++c)
+            buf[1 + c] = (s->active[r] >> c & 1) ? '@' : (s->settled[r] >> c & 1) ? '#' : ' ';
+        buf[w + 1] = '|'; buf[w + 2] = 0;
+        put_text(row, col0, tile_w, buf);
+    }
+    memset(buf, '-', (size_t)w + 2); buf[0] = buf[w + 1] = '+'; buf[w + 2] = 0;
+    put_text(row0 + h + 1, col0, tile_w, buf);
+    snprintf(buf, sizeof buf, "S%d", s->score);
+    put_text(row0 + h + 2, col0, tile_w, buf);
+    snprintf(buf, sizeof buf, "N%d g%u", s->lines, s->games);
+    put_text(row0 + h + 3, col0, tile_w, buf);
+}
+
+// append the escape-coded difference between cur and prev to out
+static size_t diff_frame(void) {
+    size_t n = 0;
+    int cr = -1, cc = -1;                        // where the terminal cursor is
+    for (int r = 0; r < term_rows; ++r) {
+        const char *a = &cur[r * term_cols], *b = &prev[r * term_cols];
+        int c = 0;
+        while (c < term_cols) {
+            if (a[c] == b[c]) { ++c; continue; }
+            int last = c;                        // bridge short unchanged gaps
+            for (int k = c + 1; k < term_cols && k - last <= 6; ++k)
+                if (a[k] != b[k]) last = k;
+            if (r != cr || c != cc)
+                n += (size_t)snprintf(out + n, out_cap - n, "\x1b[%d;%dH", r + 1, c + 1);
+            memcpy(out + n, a + c, (size_t)(last - c + 1));
+            n += (size_t)(last - c + 1);
+            cr = r; cc = last + 1;
+            c = last + 1;
+        }
+    }
+    return n;
+}
+
+static void write_all(const char *p, size_t n) {
+    while (n) {
+        ssize_t k = write(STDOUT_FILENO, p, n);
+        if (k <= 0) return;
+        p += k; n -= (size_t)k;
+    }
+}
+
+// ============================= RAW INPUT =========================
+static struct termios oldt;
+static void term_raw_enable(void) {
+    struct termios t;
+    tcgetattr(STDIN_FILENO, &oldt);
+    t = oldt;
+    t.c_lflag &= ~(ICANON | ECHO);
+    t.c_cc[VMIN]  = 0;  // non-blocking
+    t.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &t);
+    write_all("\x1b[?1049h\x1b[?25l\x1b[2J", 18);  // alt screen, hide cursor
+}
+static void term_raw_disable(void) {
+    write_all("\x1b[?25h\x1b[?1049l", 14);
+    tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
+}
+
+// ================================ MAIN ===========================
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-n games] [-r 8x8|10x20] [-t threads] [-f fps]"
+                    " [-x speed, 0 = max] [-b bot_ms] [-s seed] [-p uniform|bag]"
+                    " [-G rows/ms, e.g. 20/16 for 20G] [-c 8x8|10x20|classic|master]\n", argv0);
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "n:r:t:f:x:b:s:p:G:c:")) != -1) {
+        switch (opt) {
+            case 'n': opt_games = atoi(optarg); break;
+            case 'r': opt_rules = strcmp(optarg, "8x8") == 0 ? RULES_8X8 : RULES_10X20; break;
+            case 't': opt_threads = atoi(optarg); break;
+            case 'f': opt_fps = atoi(optarg); break;
+            case 'x': opt_speed = atof(optarg); break;
+            case 'b': opt_bot_ms = atoi(optarg); break;
+            case 's': opt_seed = strtoull(optarg, NULL, 10); break;
+            case 'G':
+                if (sscanf(optarg, "%d/%d", &opt_grav_rows, &opt_grav_ms) != 2) usage(argv[0]);
+                break;
+            case 'c':
+                for (opt_curve = SPEED_CURVES - 1; opt_curve >= 0; --opt_curve)
+                    if (strcasecmp(optarg, SPEED_CURVE_NAMES[opt_curve]) == 0) break;
+                if (opt_curve < 0) usage(argv[0]);
+                break;
+            case 'p': opt_policy = strcmp(optarg, "bag") == 0 ? PIECES_BAG : PIECES_UNIFORM; break;
+            default: usage(argv[0]);
+        }
+    }
+    if (opt_games < 1 || opt_threads < 1 || opt_fps < 1 || opt_bot_ms < 1) usage(argv[0]);
+    if (opt_threads > opt_games) opt_threads = opt_games;
+
+    slots = calloc((size_t)opt_games, sizeof *slots);
+    pubs  = aligned_alloc(64, ((size_t)opt_games * sizeof *pubs + 63) / 64 * 64);
+    Snap *shown = calloc((size_t)opt_games, sizeof *shown);
+    if (!slots || !pubs || !shown) { perror("alloc"); return 1; }
+    memset(pubs, 0, (size_t)opt_games * sizeof *pubs);
+
+    for (int id = 0; id < opt_games; ++id) {
+        game_init(&slots[id].g, opt_rules, game_stream(id, 0), 0);
+        slots[id].g.piece_policy = opt_policy;
+        if (opt_curve >= 0) slots[id].g.speed_curve = opt_curve;
+        game_set_gravity(&slots[id].g, opt_grav_rows, opt_grav_ms);
+        game_reset(&slots[id].g, game_stream(id, 0));
+        bot_init(&slots[id].bot, NULL);
+        take_snapshot(&slots[id].g, 0, &shown[id]);
+    }
+
+    signal(SIGWINCH, on_winch);
+    signal(SIGINT, on_int);
+    signal(SIGTERM, on_int);
+    term_raw_enable();
+    atexit(term_raw_disable);
+
+    pthread_t *tids = calloc((size_t)opt_threads, sizeof *tids);
+    SimRange *ranges = calloc((size_t)opt_threads, sizeof *ranges);
+    for (int t = 0; t < opt_threads; ++t) {
+        ranges[t].first = (int)((long)opt_games * t / opt_threads);
+        ranges[t].last  = (int)((long)opt_games * (t + 1) / opt_threads);
+        pthread_create(&tids[t], NULL, sim_thread, &ranges[t]);
+    }
+
+    const Game *g0 = &slots[0].g;
+    int board_w = g0->w, board_h = g0->h;
+    int tile_w = (board_w + 2 > 11 ? board_w + 2 : 11) + 1;
+    int tile_h = board_h + 4;
+
+    long period_us = 1000000L / opt_fps;
+    long next_frame = now_us(), last_stat = now_ms(), last_steps = 0;
+    double steps_per_s = 0, frame_ms = 0;
+    size_t frame_bytes = 0;
+
+    while (!atomic_load(&quit)) {
+        unsigned char ch;
+        while (read(STDIN_FILENO, &ch, 1) == 1)
+            if (ch == 'q' || ch == 'Q' || ch == 0x1B) atomic_store(&quit, 1);
+
+        if (atomic_exchange(&resized, 0)) { grid_resize(); write_all("\x1b[2J", 4); }
+
+        long t_start = now_us();
+        int per_row = term_cols / tile_w; if (per_row < 1) per_row = 1;
+        int grid_rows = (term_rows - 1) / tile_h;
+        int visible = per_row * grid_rows;
+        if (visible > opt_games) visible = opt_games;
+
+        memset(cur, ' ', (size_t)term_rows * term_cols);
+        for (int id = 0; id < visible; ++id) {
+            read_snapshot(&pubs[id], &shown[id]);
+            draw_tile((id / per_row) * tile_h, (id % per_row) * tile_w, tile_w - 1,
+                      id, &shown[id], board_w, board_h);
+        }
+
+        long t = now_ms();
+        if (t - last_stat >= 1000) {
+            long steps = atomic_load_explicit(&steps_total, memory_order_relaxed);
+            steps_per_s = (steps - last_steps) * 1000.0 / (double)(t - last_stat);
+            last_steps = steps; last_stat = t;
+        }
+        char status[160];
+        snprintf(status, sizeof status,
+                 "games %d  shown %d  %.0f steps/s  frame %.2f ms %zu B  [q] quit",
+                 opt_games, visible, steps_per_s, frame_ms, frame_bytes);
+        put_text(term_rows - 1, 0, term_cols, status);
+
+        frame_bytes = diff_frame();
+        write_all(out, frame_bytes);
+        char *tmp = prev; prev = cur; cur = tmp;
+        frame_ms = (now_us() - t_start) / 1000.0;
+
+        next_frame += period_us;
+        long wait = next_frame - now_us();
+        if (wait > 0) {
+            struct timespec ts = { .tv_sec = wait / 1000000L, .tv_nsec = (wait % 1000000L) * 1000L };
+            nanosleep(&ts, NULL);
+        } else {
+            next_frame = now_us();           // fell behind; don't try to catch up
+        }
+    }
+
+    for (int t = 0; t < opt_threads; ++t) pthread_join(tids[t], NULL);
+    return 0;
+}
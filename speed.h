@@ -0,0 +1,37 @@
+// speed.h — per-level speed curves: gravity, lock delay and level thresholds
+// The tables in speed_tables.h are generated by speedgen.c, so the games do
+// no floating point: a level-up is one table load.
+#ifndef SPEED_H
+#define SPEED_H
+
+#include <stdint.h>
+
+typedef struct {
+    uint16_t rows, per_ms;   // gravity: rows rows per per_ms ms
+    uint16_t lock_ms;        // lock delay
+    uint16_t lines;          // total lines from level 0 to reach this level
+} SpeedLevel;
+
+#include "speed_tables.h"
+
+// levels past the table keep its last entry
+static inline const SpeedLevel *speed_level(int curve, int level) {
+    if (level < 0) level = 0;
+    if (level >= SPEED_LEVELS) level = SPEED_LEVELS - 1;
+    return &SPEED_TABLES[curve][level];
+}
+
+// total lines from level 0 to level; past the table, levels keep the last step
+static inline int speed_total_lines(int curve, int level) {
+    const SpeedLevel *t = SPEED_TABLES[curve];
+    if (level < SPEED_LEVELS) return t[level].lines;
+    int step = t[SPEED_LEVELS - 1].lines - t[SPEED_LEVELS - 2].lines;
+    return t[SPEED_LEVELS - 1].lines + (level - (SPEED_LEVELS - 1)) * step;
+}
+
+// lines a game that started at start_level must clear to leave level
+static inline int speed_next_level_lines(int curve, int start_level, int level) {
+    return speed_total_lines(curve, level + 1) - speed_total_lines(curve, start_level);
+}
+
+#endif
@@ -0,0 +1,69 @@
+// speed_tables.h — generated by speedgen.c, do not edit
+#ifndef SPEED_TABLES_H
+#define SPEED_TABLES_H
+
+#define SPEED_LEVELS 30
+
+typedef enum {
+    SPEED_8X8,     // tetristest.c: 0.9 geometric, 80 ms floor, 500 ms lock
+    SPEED_10X20,   // newtetris.c: 0.9 geometric, 80 ms floor, 50 ms lock
+    SPEED_CLASSIC, // NES frame table at 60 Hz, locks on the next gravity frame
+    SPEED_MASTER,  // x1.5 per level up to 20G, lock delay 500 -> 250 ms
+    SPEED_CURVES
+} SpeedCurve;
+
+static const char *const SPEED_CURVE_NAMES[SPEED_CURVES] = { "8X8", "10X20", "CLASSIC", "MASTER" };
+
+// { rows, per_ms, lock_ms, lines } per level
+static const SpeedLevel SPEED_TABLES[SPEED_CURVES][SPEED_LEVELS] = {
+    { // SPEED_8X8
+        {     1,  1000, 500,   0 }, {     1,   900, 500,  10 }, {     1,   810, 500,  20 },
+        {     1,   729, 500,  30 }, {     1,   656, 500,  40 }, {     1,   590, 500,  50 },
+        {     1,   531, 500,  60 }, {     1,   478, 500,  70 }, {     1,   430, 500,  80 },
+        {     1,   387, 500,  90 }, {     1,   348, 500, 100 }, {     1,   313, 500, 110 },
+        {     1,   282, 500, 120 }, {     1,   254, 500, 130 }, {     1,   228, 500, 140 },
+        {     1,   205, 500, 150 }, {     1,   185, 500, 160 }, {     1,   166, 500, 170 },
+        {     1,   150, 500, 180 }, {     1,   135, 500, 190 }, {     1,   121, 500, 200 },
+        {     1,   109, 500, 210 }, {     1,    98, 500, 220 }, {     1,    88, 500, 230 },
+        {     1,    80, 500, 240 }, {     1,    80, 500, 250 }, {     1,    80, 500, 260 },
+        {     1,    80, 500, 270 }, {     1,    80, 500, 280 }, {     1,    80, 500, 290 },
+    },
+    { // SPEED_10X20
+        {     1,  1000,  50,   0 }, {     1,   900,  50,  10 }, {     1,   810,  50,  20 },
+        {     1,   729,  50,  30 }, {     1,   656,  50,  40 }, {     1,   590,  50,  50 },
+        {     1,   531,  50,  60 }, {     1,   478,  50,  70 }, {     1,   430,  50,  80 },
+        {     1,   387,  50,  90 }, {     1,   348,  50, 100 }, {     1,   313,  50, 110 },
+        {     1,   282,  50, 120 }, {     1,   254,  50, 130 }, {     1,   228,  50, 140 },
+        {     1,   205,  50, 150 }, {     1,   185,  50, 160 }, {     1,   166,  50, 170 },
+        {     1,   150,  50, 180 }, {     1,   135,  50, 190 }, {     1,   121,  50, 200 },
+        {     1,   109,  50, 210 }, {     1,    98,  50, 220 }, {     1,    88,  50, 230 },
+        {     1,    80,  50, 240 }, {     1,    80,  50, 250 }, {     1,    80,  50, 260 },
+        {     1,    80,  50, 270 }, {     1,    80,  50, 280 }, {     1,    80,  50, 290 },
+    },
+    { // SPEED_CLASSIC
+        {     1,   800, 800,   0 }, {     3,  2150, 717,  10 }, {     3,  1900, 634,  20 },
+        {     1,   550, 550,  30 }, {     3,  1400, 467,  40 }, {     3,  1150, 384,  50 },
+        {     1,   300, 300,  60 }, {     3,   650, 217,  70 }, {     3,   400, 134,  80 },
+        {     1,   100, 100,  90 }, {     3,   250,  84, 100 }, {     3,   250,  84, 110 },
+        {     3,   250,  84, 120 }, {     3,   200,  67, 130 }, {     3,   200,  67, 140 },
+        {     3,   200,  67, 150 }, {     1,    50,  50, 160 }, {     1,    50,  50, 170 },
+        {     1,    50,  50, 180 }, {     3,   100,  34, 190 }, {     3,   100,  34, 200 },
+        {     3,   100,  34, 210 }, {     3,   100,  34, 220 }, {     3,   100,  34, 230 },
+        {     3,   100,  34, 240 }, {     3,   100,  34, 250 }, {     3,   100,  34, 260 },
+        {     3,   100,  34, 270 }, {     3,   100,  34, 280 }, {     3,    50,  17, 290 },
+    },
+    { // SPEED_MASTER
+        {     3,  3200, 500,   0 }, {     9,  6400, 500,   8 }, {    27, 12800, 500,  16 },
+        {    21,  6400, 500,  24 }, {     3,   640, 500,  32 }, {     9,  1280, 500,  40 },
+        {    69,  6400, 500,  48 }, {    51,  3200, 500,  56 }, {   309, 12800, 500,  64 },
+        {   231,  6400, 500,  72 }, {   693, 12800, 500,  80 }, {   519,  6400, 475,  92 },
+        {  1557, 12800, 450, 104 }, {  1167,  6400, 425, 116 }, {   219,   800, 400, 128 },
+        {   657,  1600, 375, 140 }, {  7881, 12800, 350, 152 }, { 11823, 12800, 325, 164 },
+        {     6,     5, 300, 176 }, {     6,     5, 275, 188 }, {     6,     5, 250, 200 },
+        {     6,     5, 250, 216 }, {     6,     5, 250, 232 }, {     6,     5, 250, 248 },
+        {     6,     5, 250, 264 }, {     6,     5, 250, 280 }, {     6,     5, 250, 296 },
+        {     6,     5, 250, 312 }, {     6,     5, 250, 328 }, {     6,     5, 250, 344 },
+    },
+};
+
+#endif
@@ -0,0 +1,105 @@
+// speedgen.c — generates speed_tables.h, the per-level speed curves (speed.h)
+// build: gcc -O2 -std=c11 speedgen.c -o speedgen -lm && ./speedgen > speed_tables.h
+//
+// The games only ever load table entries, so the floating point needed to
+// shape the curves lives here and not on the RV32 board.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define LEVELS 30
+
+typedef struct { long rows, per_ms, lock_ms, lines; } Entry;
+
+static long gcd(long a, long b) { while (b) { long t = a % b; a = b; b = t; } return a; }
+
+static Entry gravity(long rows, long per_ms) {
+    long g = gcd(rows, per_ms);
+    Entry e = { rows / g, per_ms / g, 0, 0 };
+    return e;
+}
+
+// the original curve: 1000 ms * 0.9^level, never below 80 ms
+static Entry geometric(int level, long lock_ms) {
+    double ms = 1000.0 * pow(0.90, (double)level);
+    if (ms < 80.0) ms = 80.0;
+    Entry e = gravity(1, (long)ms);
+    e.lock_ms = lock_ms;
+    e.lines = 10L * level;
+    return e;
+}
+
+// NES (NTSC) frames per row; no lock delay beyond the next gravity frame
+static Entry classic(int level) {
+    static const int frames[LEVELS] = {
+        48, 43, 38, 33, 28, 23, 18, 13, 8, 6, 5, 5, 5, 4, 4, 4, 3, 3, 3,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1
+    };
+    Entry e = gravity(60, frames[level] * 1000L);
+    e.lock_ms = (frames[level] * 1000L + 59) / 60;
+    e.lines = 10L * level;
+    return e;
+}
+
+// in 1/256 rows per 60 Hz frame, x1.5 per level up to 20G, with the lock
+// delay shrinking over levels 10..20 and longer levels later on
+static Entry master(int level) {
+    long g256 = lround(4.0 * pow(1.5, (double)level));
+    if (g256 > 20 * 256) g256 = 20 * 256;
+    Entry e = gravity(g256 * 60, 256 * 1000L);
+    e.lock_ms = level <= 10 ? 500 : level >= 20 ? 250 : 500 - 25L * (level - 10);
+    e.lines = 0;
+    for (int l = 0; l < level; ++l) e.lines += 8 + 4 * (l / 10);
+    return e;
+}
+
+static const char *NAMES[] = { "SPEED_8X8", "SPEED_10X20", "SPEED_CLASSIC", "SPEED_MASTER" };
+static const char *NOTES[] = {
+    "tetristest.c: 0.9 geometric, 80 ms floor, 500 ms lock",
+    "newtetris.c: 0.9 geometric, 80 ms floor, 50 ms lock",
+    "NES frame table at 60 Hz, locks on the next gravity frame",
+    "x1.5 per level up to 20G, lock delay 500 -> 250 ms",
+};
+#define CURVES (int)(sizeof NAMES / sizeof NAMES[0])
+
+static Entry entry(int curve, int level) {
+    switch (curve) {
+        case 0:  return geometric(level, 500);
+        case 1:  return geometric(level, 50);
+        case 2:  return classic(level);
+        default: return master(level);
+    }
+}
+
+int main(void) {
+    printf("// speed_tables.h — generated by speedgen.c, do not edit\n");
+    printf("#ifndef SPEED_TABLES_H\n#define SPEED_TABLES_H\n\n");
+    printf("#define SPEED_LEVELS %d\n\n", LEVELS);
+
+    printf("typedef enum {\n");
+    for (int c = 0; c < CURVES; ++c) printf("    %s,%*s// %s\n", NAMES[c], (int)(14 - strlen(NAMES[c])), "", NOTES[c]);
+    printf("    SPEED_CURVES\n} SpeedCurve;\n\n");
+
+    printf("static const char *const SPEED_CURVE_NAMES[SPEED_CURVES] = {");
+    for (int c = 0; c < CURVES; ++c) printf("%s \"%s\"", c ? "," : "", NAMES[c] + 6);
+    printf(" };\n\n");
+
+    printf("// { rows, per_ms, lock_ms, lines } per level\n");
+    printf("static const SpeedLevel SPEED_TABLES[SPEED_CURVES][SPEED_LEVELS] = {\n");
+    for (int c = 0; c < CURVES; ++c) {
+        printf("    { // %s\n", NAMES[c]);
+        for (int l = 0; l < LEVELS; ++l) {
+            Entry e = entry(c, l);
+            if (e.rows > 65535 || e.per_ms > 65535 || e.lock_ms > 65535 || e.lines > 65535) {
+                fprintf(stderr, "speedgen: %s level %d does not fit in 16 bits\n", NAMES[c], l);
+                return 1;
+            }
+            printf("%s{ %5ld, %5ld, %3ld, %3ld },%s", l % 3 ? " " : "        ",
+                   e.rows, e.per_ms, e.lock_ms, e.lines, l % 3 == 2 ? "\n" : "");
+        }
+        printf("    },\n");
+    }
+    printf("};\n\n#endif\n");
+    return 0;
+}
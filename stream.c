@@ -0,0 +1,264 @@
+// stream.c — delta-compressed spectator stream (see stream.h)
+// build: linked into the tools that broadcast games, e.g.
+//        gcc -O2 -std=c11 -pthread streambench.c stream.c engine.c bot.c -o streambench
+#include <stdlib.h>
+#include <string.h>
+#include "stream.h"
+#include "proto.h"
+
+// ============================== Views ============================
+void stream_view_of(StreamView *v, const Game *g, uint32_t tick) {
+    v->tick = tick;
+    v->score = (uint32_t)g->score;
+    v->lines = (uint16_t)g->lines_total;
+    v->level = (uint8_t)g->level;
+    v->h = (uint8_t)g->h;
+    v->over = (uint8_t)g->over;
+    v->piece = (int8_t)g->piece;
+    v->mask = g->piece >= 0 ? g->mask : 0;
+    v->px = (int8_t)(g->piece >= 0 ? g->px : 0);
+    v->py = (int8_t)(g->piece >= 0 ? g->py : 0);
+    v->next = (int8_t)game_next(g, 0);
+    memcpy(v->rows, g->rows, sizeof v->rows);
+}
+
+int stream_view_equal(const StreamView *a, const StreamView *b) {
+    return a->tick == b->tick && a->score == b->score && a->lines == b->lines &&
+           a->level == b->level && a->h == b->h && a->over == b->over &&
+           a->piece == b->piece && a->mask == b->mask && a->px == b->px && a->py == b->py &&
+           a->next == b->next && memcmp(a->rows, b->rows, a->h * sizeof a->rows[0]) == 0;
+}
+
+// ============================= Encoding ==========================
+static int put_varint(uint8_t *p, uint32_t v) {
+    int n = 0;
+    while (v >= 0x80) { p[n++] = (uint8_t)(v | 0x80); v >>= 7; }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static int get_varint(const uint8_t *p, int len, int *off, uint32_t *v) {
+    *v = 0;
+    for (int shift = 0; shift < 35 && *off < len; shift += 7) {
+        uint8_t b = p[(*off)++];
+        *v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return 1;
+    }
+    return 0;
+}
+
+static int put_key(const StreamView *v, uint8_t *p, uint8_t flags) {
+    p[0] = MSG_KEY; p[1] = (uint8_t)(STREAM_KEY_HDR + 2 * v->h);
+    put32(p + 2, v->tick); put32(p + 6, v->score); put16(p + 10, v->lines);
+    p[12] = v->level;
+    p[13] = (uint8_t)v->piece; p[14] = (uint8_t)v->px; p[15] = (uint8_t)v->py;
+    put16(p + 16, v->mask);
+    p[18] = (uint8_t)v->next; p[19] = v->over; p[20] = v->h; p[21] = flags;
+    for (int r = 0; r < v->h; ++r) put16(p + STREAM_KEY_HDR + 2 * r, v->rows[r]);
+    return p[1];
+}
+
+// the delta from e->last to now; 0 if nothing changed, -1 if a key would
+// be no bigger
+static int put_delta(const StreamEncoder *e, const StreamView *now, uint8_t *out) {
+    const StreamView *was = &e->last;
+    uint8_t flags = 0, body[STREAM_MSG_MAX];
+    int n = 0;
+    if (now->piece != was->piece || now->mask != was->mask) {
+        flags |= DELTA_PIECE;
+        body[n++] = (uint8_t)now->piece;
+        put16(body + n, now->mask); n += 2;
+    }
+    if (now->px != was->px || now->py != was->py) {
+        flags |= DELTA_POS;
+        body[n++] = (uint8_t)now->px;
+        body[n++] = (uint8_t)now->py;
+    }
+    uint32_t changed = 0;
+    for (int r = 0; r < now->h; ++r)
+        if (now->rows[r] != was->rows[r]) changed |= 1u << r;
+    if (changed) {
+        flags |= DELTA_ROWS;
+        body[n++] = (uint8_t)changed; body[n++] = (uint8_t)(changed >> 8); body[n++] = (uint8_t)(changed >> 16);
+        for (int r = 0; r < now->h; ++r)
+            if (changed >> r & 1) { put16(body + n, now->rows[r]); n += 2; }
+    }
+    if (now->score != was->score) { flags |= DELTA_SCORE; n += put_varint(body + n, now->score - was->score); }
+    if (now->lines != was->lines) {
+        if (now->lines < was->lines || now->lines - was->lines > 255) return -1;
+        flags |= DELTA_LINES;
+        body[n++] = (uint8_t)(now->lines - was->lines);
+    }
+    if (now->level != was->level) { flags |= DELTA_LEVEL; body[n++] = now->level; }
+    if (now->next != was->next)   { flags |= DELTA_NEXT;  body[n++] = (uint8_t)now->next; }
+    if (now->over != was->over)     flags |= DELTA_OVER;
+    if (now->score < was->score) return -1;             // a new game: start from a key
+    if (!flags) return 0;
+
+    int len = 2;
+    len += put_varint(out + len, now->tick - e->last_tick);
+    out[len++] = flags;
+    if (len + n >= STREAM_KEY_HDR + 2 * now->h) return -1;
+    memcpy(out + len, body, (size_t)n);
+    len += n;
+    out[0] = MSG_DELTA; out[1] = (uint8_t)len;
+    return len;
+}
+
+void stream_encoder_init(StreamEncoder *e, uint32_t key_ticks) {
+    memset(e, 0, sizeof *e);
+    e->key_ticks = key_ticks ? key_ticks : 1;
+}
+
+int stream_encode(StreamEncoder *e, const Game *g, uint8_t *out, int *key_at) {
+    StreamView now;
+    stream_view_of(&now, g, ++e->tick);
+    *key_at = -1;
+
+    int n = -1;
+    if (e->have_key && now.h == e->last.h) {
+        n = put_delta(e, &now, out);
+        int due = now.tick - e->key_tick >= e->key_ticks;
+        if (n >= 0 && !due) {
+            if (n) { e->last = now; e->last_tick = now.tick; }
+            return n;
+        }
+    }
+    // a key: the first, one for a new board or a big delta, or one that is
+    // due (after its tick's delta, repeating the state for decoders to check)
+    uint8_t flags = n >= 0 ? KEY_REPEAT : 0;
+    if (n < 0) n = 0;
+    *key_at = n;
+    n += put_key(&now, out + n, flags);
+    e->have_key = 1;
+    e->key_tick = now.tick;
+    e->last = now;
+    e->last_tick = now.tick;
+    return n;
+}
+
+// ============================= Decoding ==========================
+int stream_decode(StreamView *v, const uint8_t *p, int len, int *keyed) {
+    *keyed = 0;
+    if (len < 2 || p[1] != len) return 0;
+    if (p[0] == MSG_KEY) {
+        if (len < STREAM_KEY_HDR || p[20] > EN_MAX_H || len != STREAM_KEY_HDR + 2 * p[20]) return 0;
+        StreamView k;
+        k.tick = get32(p + 2); k.score = get32(p + 6); k.lines = get16(p + 10);
+        k.level = p[12];
+        k.piece = (int8_t)p[13]; k.px = (int8_t)p[14]; k.py = (int8_t)p[15];
+        k.mask = get16(p + 16);
+        k.next = (int8_t)p[18]; k.over = p[19]; k.h = p[20];
+        memset(k.rows, 0, sizeof k.rows);
+        for (int r = 0; r < k.h; ++r) k.rows[r] = get16(p + STREAM_KEY_HDR + 2 * r);
+        // a repeating key must match what the deltas built
+        int ok = 1;
+        if ((p[21] & KEY_REPEAT) && v->h) {
+            v->tick = k.tick;
+            ok = stream_view_equal(v, &k);
+        }
+        *v = k;
+        *keyed = 1;
+        return ok;
+    }
+    if (p[0] != MSG_DELTA || !v->h) return 0;           // a delta needs a key first
+
+    int off = 2;
+    uint32_t dt, u;
+    if (!get_varint(p, len, &off, &dt) || off >= len) return 0;
+    uint8_t flags = p[off++];
+    v->tick += dt;
+    if (flags & DELTA_PIECE) {
+        if (off + 3 > len) return 0;
+        v->piece = (int8_t)p[off]; v->mask = get16(p + off + 1); off += 3;
+    }
+    if (flags & DELTA_POS) {
+        if (off + 2 > len) return 0;
+        v->px = (int8_t)p[off]; v->py = (int8_t)p[off + 1]; off += 2;
+    }
+    if (flags & DELTA_ROWS) {
+        if (off + 3 > len) return 0;
+        uint32_t changed = p[off] | (uint32_t)p[off + 1] << 8 | (uint32_t)p[off + 2] << 16;
+        off += 3;
+        for (int r = 0; r < v->h; ++r)
+            if (changed >> r & 1) {
+                if (off + 2 > len) return 0;
+                v->rows[r] = get16(p + off); off += 2;
+            }
+    }
+    if (flags & DELTA_SCORE) {
+        if (!get_varint(p, len, &off, &u)) return 0;
+        v->score += u;
+    }
+    if (flags & DELTA_LINES) { if (off >= len) return 0; v->lines = (uint16_t)(v->lines + p[off++]); }
+    if (flags & DELTA_LEVEL) { if (off >= len) return 0; v->level = p[off++]; }
+    if (flags & DELTA_NEXT)  { if (off >= len) return 0; v->next = (int8_t)p[off++]; }
+    if (flags & DELTA_OVER) v->over = !v->over;
+    return off == len;
+}
+
+// ============================= Fan-out ===========================
+int stream_buf_init(StreamBuf *b, size_t cap) {
+    b->data = malloc(cap);
+    b->cap = cap;
+    atomic_init(&b->head, 0);
+    atomic_init(&b->last_key, 0);
+    return b->data != NULL;
+}
+
+void stream_buf_free(StreamBuf *b) { free(b->data); b->data = NULL; }
+
+void stream_buf_put(StreamBuf *b, const uint8_t *msg, int len, int key_at) {
+    unsigned long long head = atomic_load_explicit(&b->head, memory_order_relaxed);
+    size_t at = (size_t)(head & (b->cap - 1)), first = b->cap - at;
+    if (first > (size_t)len) first = (size_t)len;
+    memcpy(b->data + at, msg, first);
+    memcpy(b->data, msg + first, (size_t)len - first);
+    if (key_at >= 0) atomic_store_explicit(&b->last_key, head + (unsigned long long)key_at, memory_order_relaxed);
+    atomic_store_explicit(&b->head, head + (unsigned long long)len, memory_order_release);
+}
+
+void stream_reader_init(StreamReader *r, StreamBuf *b) {
+    r->b = b;
+    r->pos = atomic_load_explicit(&b->last_key, memory_order_relaxed);
+    r->need_key = 0;
+    r->resyncs = 0;
+}
+
+// lapped: what is at pos may already have been overwritten
+static int lapped(const StreamBuf *b, unsigned long long head, unsigned long long pos) {
+    return head - pos + STREAM_TICK_MAX > b->cap;
+}
+
+int stream_read(StreamReader *r, uint8_t *out, int max) {
+    StreamBuf *b = r->b;
+    for (;;) {
+        unsigned long long head = atomic_load_explicit(&b->head, memory_order_acquire);
+        if (lapped(b, head, r->pos)) {                    // fell behind: back to a keyframe
+            unsigned long long key = atomic_load_explicit(&b->last_key, memory_order_relaxed);
+            r->pos = lapped(b, head, key) ? head : key;
+            r->need_key = 1;
+            r->resyncs++;
+            continue;
+        }
+        size_t n = (size_t)(head - r->pos);
+        if (n > (size_t)max) n = (size_t)max;
+        size_t at = (size_t)(r->pos & (b->cap - 1)), first = b->cap - at;
+        if (first > n) first = n;
+        memcpy(out, b->data + at, first);
+        memcpy(out + first, b->data, n - first);
+        atomic_thread_fence(memory_order_acquire);
+        // the writer may have started over what we copied in the meantime
+        if (lapped(b, atomic_load_explicit(&b->head, memory_order_relaxed), r->pos)) continue;
+
+        size_t whole = 0, skip = 0;                       // stop at a message boundary
+        while (whole + 2 <= n && out[whole + 1] >= 2 && whole + out[whole + 1] <= n) {
+            if (r->need_key && out[whole] != MSG_KEY) skip = whole + out[whole + 1];
+            else r->need_key = 0;
+            whole += out[whole + 1];
+        }
+        r->pos += whole;
+        memmove(out, out + skip, whole - skip);
+        return (int)(whole - skip);
+    }
+}
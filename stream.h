@@ -0,0 +1,108 @@
+// stream.h — delta-compressed spectator stream of one game
+// A game's stream is a sequence of proto.h-framed messages ({type, len}):
+//   KEY    the full visible state, every key_ticks ticks (right after that
+//          tick's delta, so it repeats what the deltas built and a decoder
+//          can check itself against it) and whenever a delta would not be
+//          smaller than a key
+//   DELTA  ticks since the previous message, then only what changed: the
+//          piece and its pose, the settled rows that differ, score, lines,
+//          level, next piece, game over
+// Ticks where nothing visible changed send nothing. The active piece is
+// carried as a pose, not drawn into the rows, so a move is a 6-byte delta.
+//
+// The encoder writes each message once into the game's StreamBuf, a ring
+// that any number of StreamReaders follow with their own cursor; a reader
+// that falls a whole ring behind skips to the newest keyframe.
+//
+// offsets:
+//   KEY    2 tick u32  6 score u32  10 lines u16  12 level  13 piece  14 px
+//          15 py  16 mask u16  18 next  19 over  20 h  21 flags  22 rows u16[h]
+//   DELTA  2 ticks varint, flags u8, then per flag in this order:
+//          PIECE piece, mask u16 | POS px, py | ROWS row bits u24, u16 per row
+//          SCORE varint increase | LINES u8 increase | LEVEL u8 | NEXT u8
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "engine.h"
+
+enum { MSG_KEY = 0x82, MSG_DELTA = 0x83 };
+
+#define STREAM_KEY_HDR 22
+#define STREAM_MSG_MAX (STREAM_KEY_HDR + 2 * EN_MAX_H)
+#define STREAM_TICK_MAX (2 * STREAM_MSG_MAX)  // most one tick can encode to
+
+#define KEY_REPEAT 0x01          // the key repeats the state the deltas built
+
+enum {
+    DELTA_PIECE = 0x01,
+    DELTA_POS   = 0x02,
+    DELTA_ROWS  = 0x04,
+    DELTA_SCORE = 0x08,
+    DELTA_LINES = 0x10,
+    DELTA_LEVEL = 0x20,
+    DELTA_NEXT  = 0x40,
+    DELTA_OVER  = 0x80,
+};
+
+// what a spectator sees
+typedef struct {
+    uint32_t tick;
+    uint32_t score;
+    uint16_t lines;
+    uint8_t level, h, over;
+    int8_t piece, px, py, next;
+    uint16_t mask;
+    uint16_t rows[EN_MAX_H];     // settled cells only
+} StreamView;
+
+typedef struct {
+    StreamView last;             // as the spectators have it
+    uint32_t tick;               // ticks encoded
+    uint32_t last_tick;          // tick of the last message
+    uint32_t key_tick, key_ticks;
+    int have_key;
+} StreamEncoder;
+
+void stream_view_of(StreamView *v, const Game *g, uint32_t tick);
+int stream_view_equal(const StreamView *a, const StreamView *b);
+
+void stream_encoder_init(StreamEncoder *e, uint32_t key_ticks);
+// encode the state after one more tick into out (STREAM_TICK_MAX bytes);
+// returns the bytes written, 0 if nothing changed. *key_at is the offset of
+// a keyframe among them, -1 if there is none.
+int stream_encode(StreamEncoder *e, const Game *g, uint8_t *out, int *key_at);
+
+// apply one message; returns 0 if it is malformed, or if it is a repeating
+// keyframe that disagrees with the state the deltas had built
+int stream_decode(StreamView *v, const uint8_t *msg, int len, int *keyed);
+
+// ============================= FAN-OUT ===========================
+typedef struct {
+    uint8_t *data;
+    size_t cap;                  // power of two
+    _Alignas(64) atomic_ullong head;      // bytes written so far
+    atomic_ullong last_key;      // stream offset of the newest keyframe
+} StreamBuf;
+
+typedef struct {
+    StreamBuf *b;
+    unsigned long long pos;      // stream offset of the next message to read
+    int need_key;                // lost its place: skip to the next keyframe
+    long resyncs;
+} StreamReader;
+
+int stream_buf_init(StreamBuf *b, size_t cap);
+void stream_buf_free(StreamBuf *b);
+// single writer; key_at as from stream_encode()
+void stream_buf_put(StreamBuf *b, const uint8_t *msg, int len, int key_at);
+
+// a new reader starts at the newest keyframe
+void stream_reader_init(StreamReader *r, StreamBuf *b);
+// copy whole messages, at most max bytes (>= STREAM_MSG_MAX), into out;
+// returns the bytes copied. After falling a ring behind, a reader picks up
+// again at a keyframe, so what it returns always decodes from scratch.
+int stream_read(StreamReader *r, uint8_t *out, int max);
+
+#endif
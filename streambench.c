@@ -0,0 +1,240 @@
+// streambench.c — size and cost of the spectator stream of stream.h
+// build: gcc -O2 -std=c11 -pthread streambench.c stream.c engine.c bot.c -o streambench
+// run:   ./streambench -n 500 -t 2 -d 10 -k 120
+//
+// Bot games tick every -f ms of real time (or as fast as they can with -F)
+// and each tick is encoded once into the game's StreamBuf. The encoding
+// thread decodes its own output straight away and checks it against the
+// game, so every tick is verified; subscriber threads follow all the
+// buffers like spectator connections would, rebuild each game from the
+// stream alone and check it at every repeating keyframe.
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "engine.h"
+#include "bot.h"
+#include "proto.h"
+#include "stream.h"
+
+// ============================= TIMING ============================
+static long now_ns(void) {
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)(ts.tv_sec*1000000000LL + ts.tv_nsec);
+}
+static void sleep_us(long us) {
+    struct timespec ts = { .tv_sec = us / 1000000, .tv_nsec = (us % 1000000) * 1000L };
+    nanosleep(&ts, NULL);
+}
+
+// ============================= OPTIONS ===========================
+static int opt_games = 200;
+static int opt_threads = 2;          // subscriber threads
+static int opt_seconds = 5;
+static int opt_frame_ms = 16;
+static int opt_bot_ticks = 3;        // ticks between bot actions
+static int opt_key_ticks = 120;
+static int opt_flood = 0;            // -F: do not wait for real time
+static size_t opt_ring = 4096;       // bytes of stream kept per game
+static Rules opt_rules = RULES_10X20;
+static uint64_t opt_seed = 1;
+
+// ============================= GAMES =============================
+typedef struct {
+    Game g;
+    Bot b;
+    uint32_t episodes;
+    StreamEncoder e;
+    StreamView check;                // decoded by the encoding thread
+    StreamBuf buf;
+} Slot;
+
+static Slot *slots;
+static atomic_int done;
+
+static void start_game(Slot *s, long id) {
+    Rng r;
+    rng_init(&r, opt_seed, (uint64_t)id << 32 | s->episodes++);
+    game_init(&s->g, opt_rules, r, 0);
+    bot_init(&s->b, &BOT_DEFAULT_WEIGHTS);
+}
+
+typedef struct {
+    long ticks, bytes, key_bytes, msgs, keys, state_bytes;
+    long enc_ns, dec_ns, bad;
+} Totals;
+
+static void split(const uint8_t *p, int n, StreamView *v, long *bad, long *checks) {
+    for (int off = 0; off < n; off += p[off + 1]) {
+        int keyed;
+        if (!stream_decode(v, p + off, p[off + 1], &keyed)) (*bad)++;
+        else if (keyed && checks && (p[off + 21] & KEY_REPEAT)) (*checks)++;
+    }
+}
+
+// ============================= SUBSCRIBERS =======================
+typedef struct {
+    int first, last;
+    pthread_t tid;
+    long bytes, msgs, checks, bad, resyncs;
+} Sub;
+
+static void *sub_main(void *arg) {
+    Sub *s = arg;
+    int n = s->last - s->first;
+    StreamReader *rd = calloc((size_t)n, sizeof *rd);
+    StreamView *v = calloc((size_t)n, sizeof *v);
+    long *seen = calloc((size_t)n, sizeof *seen);
+    if (!rd || !v || !seen) { perror("calloc"); exit(1); }
+    for (int i = 0; i < n; ++i) stream_reader_init(&rd[i], &slots[s->first + i].buf);
+    uint8_t out[4096];
+    while (!atomic_load(&done)) {
+        long got = 0;
+        for (int i = 0; i < n; ++i) {
+            int len = stream_read(&rd[i], out, sizeof out);
+            if (rd[i].resyncs != seen[i]) {          // lost the thread: start over from the key
+                seen[i] = rd[i].resyncs;
+                v[i].h = 0;
+            }
+            if (!len) continue;
+            for (int off = 0; off < len; off += out[off + 1]) s->msgs++;
+            split(out, len, &v[i], &s->bad, &s->checks);
+            got += len;
+        }
+        s->bytes += got;
+        if (!got) sleep_us(500);
+    }
+    for (int i = 0; i < n; ++i) s->resyncs += rd[i].resyncs;
+    free(rd); free(v); free(seen);
+    return NULL;
+}
+
+// ============================= PRODUCER ==========================
+// one tick of every game: simulate, then encode (timed as one batch),
+// publish, and decode the tick back to check it
+static void tick_all(long tick, Totals *t) {
+    for (int i = 0; i < opt_games; ++i) {
+        Slot *s = &slots[i];
+        if (s->g.over) start_game(s, i);
+        if (tick % opt_bot_ticks == 0) game_apply(&s->g, bot_next_action(&s->b, &s->g));
+        game_tick(&s->g, opt_frame_ms);
+    }
+
+    static uint8_t (*out)[STREAM_TICK_MAX];
+    static int *len, *key_at;
+    if (!out) {
+        out = malloc((size_t)opt_games * sizeof *out);
+        len = malloc((size_t)opt_games * sizeof *len);
+        key_at = malloc((size_t)opt_games * sizeof *key_at);
+        if (!out || !len || !key_at) { perror("malloc"); exit(1); }
+    }
+    long t0 = now_ns();
+    for (int i = 0; i < opt_games; ++i) len[i] = stream_encode(&slots[i].e, &slots[i].g, out[i], &key_at[i]);
+    long t1 = now_ns();
+    for (int i = 0; i < opt_games; ++i)
+        if (len[i]) stream_buf_put(&slots[i].buf, out[i], len[i], key_at[i]);
+    long t2 = now_ns();
+    for (int i = 0; i < opt_games; ++i) split(out[i], len[i], &slots[i].check, &t->bad, NULL);
+    long t3 = now_ns();
+    t->enc_ns += t1 - t0;
+    t->dec_ns += t3 - t2;
+
+    for (int i = 0; i < opt_games; ++i) {
+        Slot *s = &slots[i];
+        StreamView want;
+        stream_view_of(&want, &s->g, s->check.tick);
+        if (!stream_view_equal(&s->check, &want) || (len[i] && s->check.tick != s->e.tick)) t->bad++;
+        t->ticks++;
+        t->bytes += len[i];
+        t->state_bytes += MSG_STATE_HDR + 2 * s->g.h;
+        for (int off = 0; off < len[i]; off += out[i][off + 1]) {
+            t->msgs++;
+            if (out[i][off] == MSG_KEY) { t->keys++; t->key_bytes += out[i][off + 1]; }
+        }
+    }
+}
+
+// ================================ MAIN ===========================
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-n games] [-t threads] [-d seconds] [-f frame_ms] [-b bot_ticks]"
+                    " [-k key_ticks] [-c ring_bytes] [-r 8x8|10x20] [-s seed] [-F]\n", argv0);
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "n:t:d:f:b:k:c:r:s:F")) != -1) {
+        switch (opt) {
+            case 'n': opt_games = atoi(optarg); break;
+            case 't': opt_threads = atoi(optarg); break;
+            case 'd': opt_seconds = atoi(optarg); break;
+            case 'f': opt_frame_ms = atoi(optarg); break;
+            case 'b': opt_bot_ticks = atoi(optarg); break;
+            case 'k': opt_key_ticks = atoi(optarg); break;
+            case 'c': opt_ring = strtoul(optarg, NULL, 10); break;
+            case 'r': opt_rules = strcmp(optarg, "8x8") == 0 ? RULES_8X8 : RULES_10X20; break;
+            case 's': opt_seed = strtoull(optarg, NULL, 10); break;
+            case 'F': opt_flood = 1; break;
+            default: usage(argv[0]);
+        }
+    }
+    if (opt_games < 1 || opt_threads < 0 || opt_seconds < 1 || opt_frame_ms < 1 ||
+        opt_bot_ticks < 1 || opt_key_ticks < 1 || (opt_ring & (opt_ring - 1)) ||
+        opt_ring < 4 * STREAM_TICK_MAX)
+        usage(argv[0]);
+    if (opt_threads > opt_games) opt_threads = opt_games;
+
+    slots = calloc((size_t)opt_games, sizeof *slots);
+    Sub *subs = calloc((size_t)opt_threads + 1, sizeof *subs);
+    if (!slots || !subs) { perror("calloc"); return 1; }
+    for (int i = 0; i < opt_games; ++i) {
+        start_game(&slots[i], i);
+        stream_encoder_init(&slots[i].e, (uint32_t)opt_key_ticks);
+        if (!stream_buf_init(&slots[i].buf, opt_ring)) { perror("malloc"); return 1; }
+    }
+    for (int t = 0; t < opt_threads; ++t) {
+        subs[t].first = (int)((long)opt_games * t / opt_threads);
+        subs[t].last = (int)((long)opt_games * (t + 1) / opt_threads);
+        pthread_create(&subs[t].tid, NULL, sub_main, &subs[t]);
+    }
+
+    Totals t = { 0 };
+    long start = now_ns(), end = start + opt_seconds * 1000000000L, tick = 0;
+    for (long next = start; now_ns() < end; ++tick) {
+        tick_all(tick, &t);
+        next += opt_frame_ms * 1000000L;
+        long wait = next - now_ns();
+        if (!opt_flood && wait > 0) sleep_us(wait / 1000);
+    }
+    sleep_us(20000);                                  // let the subscribers drain
+    atomic_store(&done, 1);
+    Sub sum = { 0 };
+    for (int i = 0; i < opt_threads; ++i) {
+        pthread_join(subs[i].tid, NULL);
+        sum.bytes += subs[i].bytes; sum.msgs += subs[i].msgs;
+        sum.checks += subs[i].checks; sum.bad += subs[i].bad; sum.resyncs += subs[i].resyncs;
+    }
+
+    double wall = (now_ns() - start) / 1e9;
+    double game_s = (double)tick * opt_frame_ms / 1000.0;
+    double ticks = (double)t.ticks;
+    printf("%d games, %ld ticks of %d ms (%.1f game s each) in %.2f s, key every %d ticks\n",
+           opt_games, tick, opt_frame_ms, game_s, wall, opt_key_ticks);
+    printf("stream   %.0f B/s per game, %.2f B/tick, %.2f msgs/tick, keys %.1f%% of bytes\n",
+           t.bytes / game_s / opt_games, t.bytes / ticks, t.msgs / ticks,
+           t.bytes ? 100.0 * t.key_bytes / t.bytes : 0.0);
+    printf("vs STATE %.0f B/s per game at one per tick: %.1fx smaller\n",
+           t.state_bytes / game_s / opt_games, t.bytes ? (double)t.state_bytes / t.bytes : 0.0);
+    printf("encode   %.1f ns/tick per game   decode %.1f ns/tick per game\n",
+           t.enc_ns / ticks, t.dec_ns / ticks);
+    printf("verify   %ld ticks checked by the encoder, %ld bad\n", t.ticks, t.bad);
+    printf("readers  %d threads: %ld msgs, %.1f MB, %ld keyframe checks, %ld bad, %ld resyncs\n",
+           opt_threads, sum.msgs, sum.bytes / 1e6, sum.checks, sum.bad, sum.resyncs);
+    for (int i = 0; i < opt_games; ++i) stream_buf_free(&slots[i].buf);
+    free(slots); free(subs);
+    return t.bad || sum.bad ? 1 : 0;
+}
@@ -0,0 +1,61 @@
+// tcap.h — framebuffer capture format written by hal_host.c (TETRIS_CAPTURE)
+// and read back by tcap2ppm.c.
+//
+// File:   "TCAP" u16 version, u16 width, u16 height, u16 reserved
+// Frame:  u32 time_ms, u32 payload_len, payload
+// All integers little endian. The payload edits the previous frame (the
+// first frame edits an all-black one) as a list of ops, each a varint
+// (count << 2 | op) followed by its data:
+//   TCAP_SKIP  count pixels unchanged
+//   TCAP_FILL  count pixels of the one byte that follows
+//   TCAP_COPY  count literal pixel bytes follow
+// Pixels not reached by the ops are unchanged, so an idle frame is 8 bytes.
+#ifndef TCAP_H
+#define TCAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define TCAP_MAGIC   "TCAP"
+#define TCAP_VERSION 1
+
+enum { TCAP_SKIP, TCAP_FILL, TCAP_COPY };
+
+static inline size_t tcap_put_varint(uint8_t *p, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) { p[n++] = (uint8_t)(v | 0x80); v >>= 7; }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+// 0 on a truncated varint
+static inline size_t tcap_get_varint(const uint8_t *p, size_t avail, uint32_t *v) {
+    uint32_t x = 0;
+    for (size_t n = 0; n < avail && n < 5; ++n) {
+        x |= (uint32_t)(p[n] & 0x7f) << (7 * n);
+        if (!(p[n] & 0x80)) { *v = x; return n + 1; }
+    }
+    return 0;
+}
+
+static inline void tcap_put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8);
+}
+static inline void tcap_put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+static inline uint16_t tcap_get_u16(const uint8_t *p) { return (uint16_t)(p[0] | p[1] << 8); }
+static inline uint32_t tcap_get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// expand 8-bit RGB 3-3-2 pixels (the DE10-Lite VGA format) to 24-bit RGB
+static inline void tcap_to_rgb(const uint8_t *px, size_t n, uint8_t *rgb) {
+    for (size_t i = 0; i < n; ++i) {
+        rgb[i * 3 + 0] = (uint8_t)(((px[i] >> 5) & 7) * 255 / 7);
+        rgb[i * 3 + 1] = (uint8_t)(((px[i] >> 2) & 7) * 255 / 7);
+        rgb[i * 3 + 2] = (uint8_t)((px[i] & 3) * 255 / 3);
+    }
+}
+
+#endif
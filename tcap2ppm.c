@@ -0,0 +1,108 @@
+// tcap2ppm.c — decode a framebuffer capture (see tcap.h) into PPM frames
+// build: gcc -O2 -std=c11 tcap2ppm.c -o tcap2ppm
+// run:   ./tcap2ppm capture.tcap frame        -> frame000000.ppm, ...
+//        ./tcap2ppm capture.tcap frame 50     -> every 50th frame only
+//        ./tcap2ppm capture.tcap -            -> just print stats
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tcap.h"
+
+static int read_exact(FILE *f, void *p, size_t n) { return fread(p, 1, n, f) == n; }
+
+static void write_ppm(const char *prefix, long idx, const uint8_t *px, int w, int h, uint8_t *rgb) {
+    char path[512];
+    snprintf(path, sizeof path, "%s%06ld.ppm", prefix, idx);
+    FILE *f = fopen(path, "wb");
+    if (!f) { perror(path); exit(1); }
+    fprintf(f, "P6\n%d %d\n255\n", w, h);
+    tcap_to_rgb(px, (size_t)w * h, rgb);
+    fwrite(rgb, 1, (size_t)w * h * 3, f);
+    fclose(f);
+}
+
+// apply one frame's ops to px; 0 if the payload is malformed
+static int apply_frame(uint8_t *px, size_t npx, const uint8_t *p, size_t len) {
+    size_t at = 0, i = 0;
+    while (i < len) {
+        uint32_t tok, count;
+        size_t k = tcap_get_varint(p + i, len - i, &tok);
+        if (!k) return 0;
+        i += k;
+        count = tok >> 2;
+        if (count > npx - at) return 0;
+        switch (tok & 3) {
+            case TCAP_SKIP: break;
+            case TCAP_FILL:
+                if (i >= len) return 0;
+                memset(px + at, p[i++], count);
+                break;
+            case TCAP_COPY:
+                if (count > len - i) return 0;
+                memcpy(px + at, p + i, count);
+                i += count;
+                break;
+            default: return 0;
+        }
+        at += count;
+    }
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s capture.tcap <ppm prefix | -> [every]\n", argv[0]);
+        return 1;
+    }
+    const char *prefix = strcmp(argv[2], "-") == 0 ? NULL : argv[2];
+    long every = argc > 3 ? atol(argv[3]) : 1;
+    if (every < 1) every = 1;
+
+    FILE *f = fopen(argv[1], "rb");
+    if (!f) { perror(argv[1]); return 1; }
+
+    uint8_t hdr[12];
+    if (!read_exact(f, hdr, sizeof hdr) || memcmp(hdr, TCAP_MAGIC, 4) != 0) {
+        fprintf(stderr, "%s: not a capture file\n", argv[1]);
+        return 1;
+    }
+    if (tcap_get_u16(hdr + 4) != TCAP_VERSION) {
+        fprintf(stderr, "%s: unsupported version %u\n", argv[1], tcap_get_u16(hdr + 4));
+        return 1;
+    }
+    int w = tcap_get_u16(hdr + 6), h = tcap_get_u16(hdr + 8);
+    size_t npx = (size_t)w * h;
+
+    uint8_t *px = calloc(npx, 1), *rgb = malloc(npx * 3), *payload = NULL;
+    size_t cap = 0;
+    if (!px || !rgb) { perror("alloc"); return 1; }
+
+    long frames = 0, idle = 0, bytes = sizeof hdr, written = 0;
+    uint32_t first_ms = 0, last_ms = 0;
+    uint8_t fh[8];
+    while (read_exact(f, fh, sizeof fh)) {
+        uint32_t ms = tcap_get_u32(fh), len = tcap_get_u32(fh + 4);
+        if (len > cap) {
+            cap = len;
+            payload = realloc(payload, cap);
+            if (!payload) { perror("alloc"); return 1; }
+        }
+        if (!read_exact(f, payload, len) || !apply_frame(px, npx, payload, len)) {
+            fprintf(stderr, "%s: frame %ld is corrupt or truncated\n", argv[1], frames);
+            return 1;
+        }
+        if (frames == 0) first_ms = ms;
+        last_ms = ms;
+        if (len == 0) idle++;
+        bytes += (long)len + 8;
+        if (prefix && frames % every == 0) write_ppm(prefix, written++, px, w, h, rgb);
+        frames++;
+    }
+    fclose(f);
+
+    printf("%dx%d, %ld frames (%ld idle) over %u ms, %ld bytes (%.1f B/frame)",
+           w, h, frames, idle, last_ms - first_ms, bytes, frames ? (double)bytes / frames : 0.0);
+    if (prefix) printf(", %ld PPM written", written);
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,131 @@
+// tetrisenv.c — vectorized environment API (see tetrisenv.h)
+// build: gcc -O2 -std=c11 -shared -fPIC tetrisenv.c engine.c -o libtetrisenv.so
+//
+// The games sit in one array and are stepped in order, so a batch streams
+// through memory once. One TetrisEnv is meant for one thread; to use more
+// cores, run one per thread (the Python binding drops the GIL while stepping).
+#include <stdlib.h>
+#include <string.h>
+#include "tetrisenv.h"
+
+struct TetrisEnv {
+    int n, frame_ms;
+    uint64_t seed;
+    TenvBuffers out;
+    uint32_t *episodes;      // games finished per env
+    Game games[];
+};
+
+static Rng episode_stream(const TetrisEnv *e, int i) {
+    Rng r;
+    rng_init(&r, e->seed, (uint64_t)i << 32 | e->episodes[i]);
+    return r;
+}
+
+// ============================ Observations =======================
+static void write_stats(const TetrisEnv *e, int i) {
+    const Game *g = &e->games[i];
+    int32_t *s = &e->out.stats[(size_t)i * TENV_STATS];
+    s[0] = g->score;
+    s[1] = g->lines_total;
+    s[2] = g->level;
+    s[3] = (int32_t)g->pieces;
+}
+
+static void write_obs(const TetrisEnv *e, int i) {
+    const Game *g = &e->games[i];
+    if (e->out.board) {
+        uint16_t *settled = &e->out.board[(size_t)i * TENV_PLANES * TENV_ROWS];
+        uint16_t *active = settled + TENV_ROWS;
+        memcpy(settled, g->rows, sizeof g->rows);
+        memset(active, 0, TENV_ROWS * sizeof *active);
+        if (g->piece >= 0)
+            for (int r = 0; r < 4; ++r) {
+                unsigned nib = (g->mask >> (r * 4)) & 0xF;
+                int gr = g->py + r;
+                if (nib && gr >= 0 && gr < g->h)
+                    active[gr] = (uint16_t)(g->px >= 0 ? nib << g->px : nib >> -g->px);
+            }
+    }
+    if (e->out.piece) {
+        int8_t *p = &e->out.piece[(size_t)i * TENV_PIECE];
+        p[0] = (int8_t)g->piece;
+        p[1] = (int8_t)g->px;
+        p[2] = (int8_t)g->py;
+        p[3] = (int8_t)g->ghost_py;
+    }
+    if (e->out.preview) {
+        int8_t *q = &e->out.preview[(size_t)i * TENV_PREVIEW];
+        for (int k = 0; k < TENV_PREVIEW; ++k) q[k] = (int8_t)game_next(g, k);
+    }
+}
+
+// ============================== Stepping =========================
+void tenv_step(TetrisEnv *e, const uint8_t *actions) {
+    for (int i = 0; i < e->n; ++i) {
+        Game *g = &e->games[i];
+        int score = g->score;
+        game_apply(g, actions ? actions[i] : ACT_NONE);
+        game_tick(g, e->frame_ms);
+        if (e->out.reward) e->out.reward[i] = g->score - score;
+        if (e->out.stats) write_stats(e, i);     // before the reset: totals of the ended game
+        if (e->out.done) e->out.done[i] = (uint8_t)g->over;
+        if (g->over) {
+            e->episodes[i]++;
+            game_reset(g, episode_stream(e, i));
+        }
+        write_obs(e, i);
+    }
+}
+
+void tenv_reset(TetrisEnv *e, uint64_t seed) {
+    e->seed = seed;
+    for (int i = 0; i < e->n; ++i) {
+        e->episodes[i] = 0;
+        game_reset(&e->games[i], episode_stream(e, i));
+        if (e->out.reward) e->out.reward[i] = 0;
+        if (e->out.done) e->out.done[i] = 0;
+        if (e->out.stats) write_stats(e, i);
+        write_obs(e, i);
+    }
+}
+
+// ============================== Setup ============================
+TetrisEnv *tenv_create(int n, int rules, uint64_t seed, int frame_ms,
+                       int start_level, int policy) {
+    if (n < 1 || frame_ms < 1 || start_level < 0) return NULL;
+    if (rules != RULES_8X8 && rules != RULES_10X20) return NULL;
+    if (policy != PIECES_UNIFORM && policy != PIECES_BAG) return NULL;
+
+    TetrisEnv *e = calloc(1, sizeof *e + (size_t)n * sizeof(Game));
+    if (!e) return NULL;
+    e->episodes = calloc((size_t)n, sizeof *e->episodes);
+    if (!e->episodes) { free(e); return NULL; }
+    e->n = n;
+    e->frame_ms = frame_ms;
+    e->seed = seed;
+    for (int i = 0; i < n; ++i) {
+        Game *g = &e->games[i];
+        game_init(g, (Rules)rules, episode_stream(e, i), start_level);
+        if (policy != PIECES_UNIFORM) {
+            g->piece_policy = (PiecePolicy)policy;
+            game_reset(g, episode_stream(e, i));
+        }
+    }
+    return e;
+}
+
+void tenv_destroy(TetrisEnv *e) {
+    if (!e) return;
+    free(e->episodes);
+    free(e);
+}
+
+int tenv_count(const TetrisEnv *e) { return e->n; }
+
+void tenv_bind(TetrisEnv *e, const TenvBuffers *b) {
+    if (b) e->out = *b;
+    else memset(&e->out, 0, sizeof e->out);
+}
+
+const Game *tenv_game(const TetrisEnv *e, int i) { return &e->games[i]; }
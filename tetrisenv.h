@@ -0,0 +1,53 @@
+// tetrisenv.h — vectorized environment API for training agents on the engine
+// One TetrisEnv steps n games of the same rules in one call. The caller owns
+// the observation arrays and binds them once; every step writes straight into
+// them, so a step allocates and copies nothing beyond the observation itself.
+// tetrisenv.py wraps this for Python (ctypes).
+//
+// Games that end are reset in the same step: their observation is the first
+// one of the next game, done[i] is set and stats[i] holds the totals of the
+// game that ended. Game k of env i uses Philox stream (i << 32 | k) of the
+// seed, the same numbering as spectate.c, so any episode can be replayed.
+#ifndef TETRISENV_H
+#define TETRISENV_H
+
+#include <stdint.h>
+#include "engine.h"
+
+#define TENV_ROWS    EN_MAX_H   // rows per plane; the 8x8 rules use the first 8
+#define TENV_PLANES  2          // 0 settled cells, 1 active piece
+#define TENV_PREVIEW 5          // upcoming pieces, <= PIECE_PREVIEW_MAX
+#define TENV_PIECE   4          // shape, px, py, ghost_py
+#define TENV_STATS   4          // score, lines, level, pieces
+
+typedef struct TetrisEnv TetrisEnv;
+
+// caller-provided arrays, n entries each, C order; NULL skips that output
+typedef struct {
+    uint16_t *board;    // [n][TENV_PLANES][TENV_ROWS], bit c of a row = column c
+    int8_t *piece;      // [n][TENV_PIECE], shape -1 when no piece is falling
+    int8_t *preview;    // [n][TENV_PREVIEW]
+    int32_t *reward;    // [n] score gained by the step
+    uint8_t *done;      // [n] the game ended in the step (and was reset)
+    int32_t *stats;     // [n][TENV_STATS], running totals or those of the ended game
+} TenvBuffers;
+
+// frame_ms of game time pass per step (gravity, lock delay);
+// rules, start_level and policy as in engine.h. NULL on bad arguments.
+TetrisEnv *tenv_create(int n, int rules, uint64_t seed, int frame_ms,
+                       int start_level, int policy);
+void tenv_destroy(TetrisEnv *e);
+
+int tenv_count(const TetrisEnv *e);
+void tenv_bind(TetrisEnv *e, const TenvBuffers *b);
+
+// restart every game from episode 0 of seed and write the first observation
+void tenv_reset(TetrisEnv *e, uint64_t seed);
+
+// actions[i] is one of ACT_* for game i; out-of-range values do nothing
+void tenv_step(TetrisEnv *e, const uint8_t *actions);
+
+// the game behind env i, e.g. for rendering or a bot baseline
+const Game *tenv_game(const TetrisEnv *e, int i);
+
+#endif
@@ -0,0 +1,151 @@
+"""tetrisenv.py — Python binding for the vectorized environment (tetrisenv.h)
+
+build the library first:
+    gcc -O2 -std=c11 -shared -fPIC tetrisenv.c engine.c -o libtetrisenv.so
+
+    env = TetrisEnv(1024, rules="10x20", seed=1)
+    obs = env.reset()
+    while True:
+        obs, reward, done, stats = env.step(actions)   # actions: 1024 uint8
+
+The observation arrays are allocated here once and bound to the C side, so
+step() only passes the action pointer: obs, reward, done and stats are the
+same arrays every call, overwritten in place (numpy views when numpy is
+installed, flat memoryviews otherwise). Copy them if you keep them across steps.
+ctypes releases the GIL for the call, so several TetrisEnvs can be stepped
+from several Python threads at once.
+"""
+import ctypes
+import os
+
+try:
+    import numpy as np
+except ImportError:
+    np = None
+
+ROWS, PLANES, PREVIEW, PIECE, STATS = 20, 2, 5, 4, 4    # TENV_* in tetrisenv.h
+RULES = {"8x8": 0, "10x20": 1}
+POLICIES = {"uniform": 0, "bag": 1}
+ACT_NONE, ACT_LEFT, ACT_RIGHT, ACT_ROTATE, ACT_SOFT_DROP, ACT_HARD_DROP = range(6)
+ACT_COUNT = 6
+
+
+class TenvBuffers(ctypes.Structure):
+    _fields_ = [
+        ("board", ctypes.POINTER(ctypes.c_uint16)),
+        ("piece", ctypes.POINTER(ctypes.c_int8)),
+        ("preview", ctypes.POINTER(ctypes.c_int8)),
+        ("reward", ctypes.POINTER(ctypes.c_int32)),
+        ("done", ctypes.POINTER(ctypes.c_uint8)),
+        ("stats", ctypes.POINTER(ctypes.c_int32)),
+    ]
+
+
+def _load(path=None):
+    path = path or os.environ.get("TETRISENV_LIB") or \
+        os.path.join(os.path.dirname(os.path.abspath(__file__)), "libtetrisenv.so")
+    lib = ctypes.CDLL(path)
+    lib.tenv_create.restype = ctypes.c_void_p
+    lib.tenv_create.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_uint64, ctypes.c_int,
+                                ctypes.c_int, ctypes.c_int]
+    lib.tenv_destroy.argtypes = [ctypes.c_void_p]
+    lib.tenv_bind.argtypes = [ctypes.c_void_p, ctypes.POINTER(TenvBuffers)]
+    lib.tenv_reset.argtypes = [ctypes.c_void_p, ctypes.c_uint64]
+    lib.tenv_step.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+    return lib
+
+
+_lib = None
+
+
+# without numpy, a flat memoryview in the same C order
+def _view(buf, shape):
+    if np is not None:
+        return np.ctypeslib.as_array(buf).reshape(shape)
+    return memoryview(buf).cast("B").cast(buf._type_._type_)
+
+
+class TetrisEnv:
+    def __init__(self, n, rules="10x20", seed=0, frame_ms=16, start_level=0,
+                 policy="uniform", lib=None):
+        global _lib
+        self.lib = _load(lib) if lib else (_lib or _load())
+        _lib = _lib or self.lib
+        self.n = n
+        self.seed = seed
+        self.width, self.height = (8, 8) if rules == "8x8" else (10, 20)
+        self._env = self.lib.tenv_create(n, RULES[rules], seed, frame_ms, start_level,
+                                         POLICIES[policy])
+        if not self._env:
+            raise ValueError("tenv_create: bad arguments")
+
+        self._board = (ctypes.c_uint16 * (n * PLANES * ROWS))()
+        self._piece = (ctypes.c_int8 * (n * PIECE))()
+        self._preview = (ctypes.c_int8 * (n * PREVIEW))()
+        self._reward = (ctypes.c_int32 * n)()
+        self._done = (ctypes.c_uint8 * n)()
+        self._stats = (ctypes.c_int32 * (n * STATS))()
+        self._actions = (ctypes.c_uint8 * n)()
+        self._bufs = TenvBuffers(self._board, self._piece, self._preview,
+                                 self._reward, self._done, self._stats)
+        self.lib.tenv_bind(self._env, ctypes.byref(self._bufs))
+
+        self.obs = {
+            "board": _view(self._board, (n, PLANES, ROWS)),
+            "piece": _view(self._piece, (n, PIECE)),
+            "preview": _view(self._preview, (n, PREVIEW)),
+        }
+        self.reward = _view(self._reward, (n,))
+        self.done = _view(self._done, (n,))
+        self.stats = _view(self._stats, (n, STATS))
+        self.actions = _view(self._actions, (n,))   # may be filled in place
+
+    def reset(self, seed=None):
+        if seed is not None:
+            self.seed = seed
+        self.lib.tenv_reset(self._env, self.seed)
+        return self.obs
+
+    def step(self, actions=None):
+        """actions: None to use self.actions as filled by the caller, a
+        contiguous uint8 numpy array, or any sequence of n ints"""
+        if actions is None:
+            ptr = ctypes.addressof(self._actions)
+        elif np is not None and isinstance(actions, np.ndarray):
+            if actions.shape != (self.n,):
+                raise ValueError("actions must have shape (%d,), got %s" % (self.n, actions.shape))
+            actions = np.ascontiguousarray(actions, dtype=np.uint8)
+            ptr = actions.ctypes.data
+        else:
+            self._actions[:] = actions
+            ptr = ctypes.addressof(self._actions)
+        self.lib.tenv_step(self._env, ptr)
+        return self.obs, self.reward, self.done, self.stats
+
+    def close(self):
+        if self._env:
+            self.lib.tenv_destroy(self._env)
+            self._env = None
+
+    def __del__(self):
+        self.close()
+
+
+if __name__ == "__main__":
+    import random
+    import sys
+    import time
+
+    n = int(sys.argv[1]) if len(sys.argv) > 1 else 4096
+    env = TetrisEnv(n, seed=1)
+    env.reset(1)
+    rnd = random.Random(1)
+    for i in range(n):
+        env.actions[i] = rnd.randrange(ACT_COUNT)
+    steps, games, t0 = 0, 0, time.perf_counter()
+    while time.perf_counter() - t0 < 2.0:
+        env.step()
+        games += sum(env.done) if np is None else int(env.done.sum())
+        steps += n
+    dt = time.perf_counter() - t0
+    print(f"{n} envs: {steps / dt / 1e6:.2f} M steps/s, {games} games ended")
@@ -1,14 +1,25 @@
 // tetris8x8.c — 8x8 Tetris with Menu/Options; bottom row clearable
-// build: gcc -O2 -std=c11 tetris8x8.c -o tetris -lm
-// run:   ./tetris
+// build: gcc -O2 -std=c11 -pthread tetristest.c events.c -o tetris
+// run:   ./tetris            (TETRIS_EVENTS=game.events ./tetris logs gameplay events)
+#define _DEFAULT_SOURCE   // clock_gettime & co. under -std=c11 on glibc
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <time.h>
 #include <termios.h>
-#include <math.h>
 #include <stdbool.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#ifdef __linux__
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#else
+#include <poll.h>
+#endif
+#include "rng.h"
+#include "speed.h"
+#include "events.h"
 
 // ============================= INPUT =============================
 enum {
@@ -30,6 +41,18 @@ static long now_ms(void) {
     return (long)(ts.tv_sec*1000LL + ts.tv_nsec/1000000LL);
 }
 
+// ============================= EVENTS ============================
+// gameplay events go to a ring that events.c writes out in the background
+static EvRing *ev_ring;              // NULL unless TETRIS_EVENTS is set
+static long game_start_ms;
+static unsigned games_started = 0;
+static unsigned game_id;             // the piece stream the game in play was given
+
+static void emit(int type, int a, int b, uint32_t c) {
+    if (ev_ring) ev_push(ev_ring, game_id, (uint32_t)(now_ms() - game_start_ms), type, a, b, c);
+}
+static void events_stop(void) { ev_log_stop(NULL); }
+
 // ============================= BOARD/STATE =======================
 #define W 8
 #define H 8
@@ -41,11 +64,19 @@ static int score = 0;
 
 static int level = 0, lines_total = 0;
 static int fall_interval_ms = 1000;
-static long fall_timer_ms = 0;
+static int fall_rows = 1;          // gravity: fall_rows rows per fall_interval_ms
+static long fall_acc = 0;          // ms * fall_rows not yet due as a row
+static int lock_delay_ms = 500;
+static int next_level_lines = 10;  // lines_total at which level goes up
 static long lock_timer_ms = 0;
+static int col_height[W];          // skyline, see drop_distance()
+static int ghost_drop = -1;        // rows the active piece can still fall, -1 = none
 
 static int opt_start_level = 0;       // Options menu
 static int opt_soft_drop_enabled = 0; // Options menu
+static int opt_bag_randomizer = 0;    // Options menu: 0 uniform, 1 bag of all 6
+static int opt_20g = 0;               // Options menu: 20 rows per display tick
+static int opt_speed_curve = SPEED_8X8; // Options menu, see speed.h
 
 // board
 static char one[W]   = {'0','0','0','0','0','0','0','0'};
@@ -66,14 +97,15 @@ static void clear_board(void) {
 
 static void print_pixels(void) {
     printf("Score: %d\n", score);
-    for (int i = 0; i < W; ++i) printf("%c", one[i]);   printf("\n");
-    for (int i = 0; i < W; ++i) printf("%c", two[i]);   printf("\n");
-    for (int i = 0; i < W; ++i) printf("%c", three[i]); printf("\n");
-    for (int i = 0; i < W; ++i) printf("%c", four[i]);  printf("\n");
-    for (int i = 0; i < W; ++i) printf("%c", five[i]);  printf("\n");
-    for (int i = 0; i < W; ++i) printf("%c", six[i]);   printf("\n");
-    for (int i = 0; i < W; ++i) printf("%c", seven[i]); printf("\n");
-    for (int i = 0; i < W; ++i) printf("%c", eight[i]); printf("\n");
+    for (int r = 0; r < H; ++r) {
+        for (int c = 0; c < W; ++c) {
+            char ch = rows[r][c];
+            // ghost: where the active piece would land
+            if (ch == '0' && ghost_drop > 0 && r >= ghost_drop && rows[r - ghost_drop][c] == '1') ch = '.';
+            printf("%c", ch);
+        }
+        printf("\n");
+    }
 }
 static int has_active_piece(void) {
     for (int r = 0; r < H; ++r)
@@ -83,11 +115,10 @@ static int has_active_piece(void) {
 }
 
 // ============================= RNG ===============================
-static int roll_dn(int n) {                        // unbiased 0..n-1
-    int limit = RAND_MAX - (RAND_MAX % n), r;
-    do { r = rand(); } while (r >= limit);
-    return r % n;
-}
+// every game gets its own stream split off the seed, so game k of a seed
+// deals the same pieces no matter what happened in games 0..k-1
+static Rng seed_rng;
+static PieceQueue pieces;                          // upcoming shapes
 static unsigned int get_seed(void) {               // read seed once
     unsigned int s;
     printf("Enter a seed: ");
@@ -111,30 +142,125 @@ static void term_raw_enable(void) {
 }
 static void term_raw_disable(void) { tcsetattr(STDIN_FILENO, TCSANOW, &oldt); }
 
-static int poll_key(void) {
-    unsigned char ch;
-    ssize_t n = read(STDIN_FILENO, &ch, 1);
-    if (n <= 0) return 0; // no key
+// Pending bytes are drained with one readv() into a ring buffer and decoded
+// incrementally, so an escape sequence split across reads is still one key.
+#define IN_RING     256         // power of two
+#define CSI_MAX     16          // longest escape sequence we bother parsing
+#define ESC_WAIT_MS 25          // a lone ESC is a key once nothing follows it
+
+typedef struct { int key; long t_ms; } KeyEvent;
+
+static unsigned char in_ring[IN_RING];
+static unsigned in_head, in_tail;   // read / write positions, free-running
+static long in_last_read_ms;
+
+static void input_fill(void) {
+    unsigned used = in_tail - in_head, room = IN_RING - used;
+    if (!room) return;
+    unsigned at = in_tail & (IN_RING - 1);
+    unsigned first = IN_RING - at < room ? IN_RING - at : room;
+    struct iovec iov[2] = {
+        { in_ring + at, first },
+        { in_ring,      room - first },
+    };
+    ssize_t n = readv(STDIN_FILENO, iov, room > first ? 2 : 1);
+    if (n > 0) { in_tail += (unsigned)n; in_last_read_ms = now_ms(); }
+}
+
+static unsigned char in_peek(unsigned i) { return in_ring[(in_head + i) & (IN_RING - 1)]; }
 
+static int decode_plain(unsigned char ch) {
     if (ch == ' ') return KEY_SPACE;
     if (ch == 'a' || ch == 'A') return KEY_LEFT_MOVE;
     if (ch == 'd' || ch == 'D') return KEY_RIGHT_MOVE;
     if (ch == 'w' || ch == 'W') return KEY_ROTATE;
-
-    if (ch == 0x1B) { // ESC or an escape sequence
-        unsigned char b1=0, b2=0;
-        ssize_t n1 = read(STDIN_FILENO, &b1, 1);
-        if (n1 <= 0) return KEY_ESC; // plain ESC
-        ssize_t n2 = read(STDIN_FILENO, &b2, 1);
-        if (n2 <= 0) return KEY_ESC;
-        if (b1 == '[' && b2 == 'D') return KEY_ARROW_LEFT;
-        if (b1 == '[' && b2 == 'C') return KEY_ARROW_RIGHT;
-        return KEY_ESC;
-    }
     // menu letters handled directly where used
     return ch; // return raw char for 'p','o','q','b','s'
 }
 
+// decode the key at the front of the ring; returns bytes consumed (0 = the
+// sequence is incomplete, wait for more) and sets *key (0 = ignored bytes)
+static unsigned decode_one(int *key, long now) {
+    unsigned avail = in_tail - in_head;
+    unsigned char ch = in_peek(0);
+    *key = 0;
+    if (ch != 0x1B) { *key = decode_plain(ch); return 1; }
+
+    if (avail == 1) { // ESC or the start of a sequence still in flight
+        if (now - in_last_read_ms < ESC_WAIT_MS) return 0;
+        *key = KEY_ESC;
+        return 1;
+    }
+    unsigned char b1 = in_peek(1);
+    if (b1 != '[' && b1 != 'O') { *key = KEY_ESC; return 1; } // plain ESC, then b1
+
+    // CSI: ESC [ params final, SS3: ESC O final
+    for (unsigned i = 2; i < avail && i < CSI_MAX; ++i) {
+        unsigned char b = in_peek(i);
+        if (b >= 0x40 && b <= 0x7E) {
+            if (b == 'D') *key = KEY_ARROW_LEFT;
+            else if (b == 'C') *key = KEY_ARROW_RIGHT;
+            return i + 1; // other sequences are dropped
+        }
+    }
+    if (avail >= CSI_MAX) return CSI_MAX; // runaway sequence, drop it
+    if (now - in_last_read_ms < ESC_WAIT_MS) return 0;
+    return avail;                         // truncated sequence, drop it
+}
+
+// read everything pending and return up to max decoded, timestamped keys
+static int input_poll(KeyEvent *ev, int max) {
+    input_fill();
+    long now = now_ms();
+    int n = 0;
+    while (n < max && in_tail != in_head) {
+        int key;
+        unsigned used = decode_one(&key, now);
+        if (!used) break;
+        in_head += used;
+        if (key) { ev[n].key = key; ev[n].t_ms = in_last_read_ms; n++; }
+    }
+    return n;
+}
+
+// ============================ Skyline ============================
+// col_height[c] = rows from the floor up to the top settled cell of column
+// c, kept current by lock_piece(). The landing row then follows from the
+// piece's lowest cell per column, without stepping the piece down row by row.
+static void skyline_add(int r, int c) { if (col_height[c] < H - r) col_height[c] = H - r; }
+
+// every cleared row was full, so it lay under each column's top; lower the
+// tops by that much and walk down past holes that became the top
+static void skyline_after_clear(int cleared) {
+    for (int c = 0; c < W; ++c) {
+        int h = col_height[c] - cleared;
+        while (h > 0 && rows[H - h][c] != '2') --h;
+        col_height[c] = h;
+    }
+}
+
+// rows the active piece can fall before it rests, -1 if there is none
+static int drop_distance(void) {
+    int bottom[W];                              // lowest active row per column
+    for (int c = 0; c < W; ++c) bottom[c] = -1;
+    for (int r = 0; r < H; ++r)
+        for (int c = 0; c < W; ++c)
+            if (rows[r][c] == '1') bottom[c] = r;
+
+    int drop = -1;
+    for (int c = 0; c < W; ++c) {
+        if (bottom[c] < 0) continue;
+        int r = bottom[c] + 1, top = H - col_height[c];
+        if (r <= top) r = top;                            // above the skyline
+        else while (r < H && rows[r][c] != '2') ++r;      // tucked under an overhang
+        if (drop < 0 || r - 1 - bottom[c] < drop) drop = r - 1 - bottom[c];
+    }
+    return drop;
+}
+
+// only needed when the piece moves sideways or rotates; falling keeps the landing row
+static void update_ghost(void) { ghost_drop = drop_distance(); }
+
 // ========== Active-block bounds + rotation helpers (4x4 box) ==========
 typedef struct { int x0, y0, x1, y1, found; } AABB;
 
@@ -217,7 +343,7 @@ static void rotate_active_block(int dir) {
         for (int c = 0; c < 4; ++c)
             rot[r][c] = box[r][c];
     if (dir < 0) rotate_left4(rot); else rotate_right4(rot);
-    (void)try_apply_rotated_4x4(rot, b);
+    if (try_apply_rotated_4x4(rot, b)) { update_ghost(); emit(EV_ROTATE, dir, 0, 0); }
 }
 
 // ======================= Movement & Gravity ======================
@@ -232,6 +358,21 @@ static int can_move_horiz(int dx) {
     }
     return 1;
 }
+// top-left of the active cells, which is the engine's px / py for the
+// 8x8 rules (pieces stay anchored to their bounding box)
+static int piece_x(void) {
+    int px = W;
+    for (int r = 0; r < H; ++r)
+        for (int c = 0; c < px; ++c)
+            if (rows[r][c] == '1') px = c;
+    return px;
+}
+static int piece_y(void) {
+    for (int r = 0; r < H; ++r)
+        for (int c = 0; c < W; ++c)
+            if (rows[r][c] == '1') return r;
+    return H;
+}
 static void move_piece_horiz(int dx) {
     if (!dx || !can_move_horiz(dx)) return;
     if (dx > 0) {
@@ -243,6 +384,8 @@ static void move_piece_horiz(int dx) {
             for (int c = 0; c < W; ++c)
                 if (rows[r][c] == '1') { rows[r][c-1] = '1'; rows[r][c] = '0'; }
     }
+    update_ghost();
+    emit(EV_MOVE, dx, piece_x(), 0);
 }
 static int can_piece_fall(void) {
     for (int r = H-1; r >= 0; --r)
@@ -253,11 +396,14 @@ static int can_piece_fall(void) {
             }
     return 1;
 }
-static void move_piece_down(void) {
+static void move_piece_down_by(int n) {
+    if (n <= 0) return;                            // resting: a zero move would erase the piece
     for (int r = H-1; r >= 0; --r)
         for (int c = 0; c < W; ++c)
-            if (rows[r][c] == '1') { rows[r+1][c] = '1'; rows[r][c] = '0'; }
+            if (rows[r][c] == '1') { rows[r+n][c] = '1'; rows[r][c] = '0'; }
+    if (ghost_drop >= n) ghost_drop -= n;
 }
+static void move_piece_down(void) { move_piece_down_by(1); }
 
 // =============== Line clear + collapse + scoring/level ===========
 static int clear_full_lines_and_collapse(void) {
@@ -276,30 +422,49 @@ static int clear_full_lines_and_collapse(void) {
     }
     return cleared;
 }
+// gravity and lock delay of the current level; 20G is 20 rows per 16 ms display tick
+static void load_speed(void) {
+    const SpeedLevel *s = speed_level(opt_speed_curve, level);
+    lock_delay_ms = s->lock_ms;
+    if (opt_20g) { fall_rows = 20; fall_interval_ms = 16; return; }
+    fall_rows = s->rows;
+    fall_interval_ms = s->per_ms;
+}
 static void apply_scoring_and_level(int lines_cleared) {
     if (lines_cleared == 1) score += 100;
     else if (lines_cleared == 2) score += 300;
     else if (lines_cleared == 3) score += 500;
     else if (lines_cleared >= 4) score += 800;
 
+    if (lines_cleared) emit(EV_LINES, lines_cleared, 0, (uint32_t)score);
     lines_total += lines_cleared;
-    int new_level = lines_total / 10; // 10 lines per level
-    if (new_level != level) {
-        level = new_level;
-        double ms = 1000.0 * pow(0.90, (double)level);
-        if (ms < 80.0) ms = 80.0;
-        fall_interval_ms = (int)ms;
+    while (lines_total >= next_level_lines) {
+        level++;
+        emit(EV_LEVEL, level, 0, 0);
+        next_level_lines = speed_next_level_lines(opt_speed_curve, opt_start_level, level);
+        load_speed();
     }
 }
+static int cur_shape = -1;
+static long pieces_locked = 0;
+
 static void lock_piece(void) {
+    emit(EV_LOCK, cur_shape, piece_x() | piece_y() << 8, (uint32_t)++pieces_locked);
     for (int r = 0; r < H; ++r)
         for (int c = 0; c < W; ++c)
-            if (rows[r][c] == '1') rows[r][c] = '2';
+            if (rows[r][c] == '1') { rows[r][c] = '2'; skyline_add(r, c); }
     int lines = clear_full_lines_and_collapse();
+    if (lines) skyline_after_clear(lines);
     apply_scoring_and_level(lines);
     new_block = 1;
     lock_timer_ms = 0;
-    fall_timer_ms = 0;
+    fall_acc = 0;
+    ghost_drop = -1;
+}
+static void hard_drop(void) {                      // one move straight to the ghost
+    if (ghost_drop < 0) return;
+    move_piece_down_by(ghost_drop);
+    lock_piece();
 }
 
 // ============================== Shapes ===========================
@@ -320,13 +485,14 @@ static void spawn_random_block(void) {
     if (!new_block) return;
     if (x < 0) x = 0; if (x > 4) x = 4;
 
-    int idx = roll_dn(6);
+    int idx = pieces_next(&pieces);
     const char (*shape)[4] = SHAPES[idx];
 
     // game over check: overlap with settled in the 4x4 spawn area (rows 0..3)
     for (int r = 0; r < 4; ++r)
         for (int c = 0; c < 4; ++c)
             if (shape[r][c] == '1' && rows[r][x + c] == '2') {
+                emit(EV_OVER, 0, 0, (uint32_t)score);
                 print_pixels();
                 printf("Game Over (blocked by settled cells)\n");
                 exit(0);
@@ -343,28 +509,41 @@ static void spawn_random_block(void) {
             if (shape[r][c] == '1') rows[r][x + c] = '1';
 
     new_block = 0;
-    printf("[spawned: %s]\n", SHAPE_NAMES[idx]);
+    cur_shape = idx;
+    update_ghost();
+    emit(EV_SPAWN, idx, x, 0);
 }
 
 // ========================= Gravity (time-based) ==================
-static void gravity_step(int dt_ms) {
-    if (!has_active_piece()) return;
-
-    fall_timer_ms += dt_ms;
-    while (fall_timer_ms >= fall_interval_ms) {
-        fall_timer_ms -= fall_interval_ms;
-
-        if (can_piece_fall()) {
-            move_piece_down();
-            if (can_piece_fall()) lock_timer_ms = 0; // still airborne afterwards
-        } else {
-            lock_timer_ms += fall_interval_ms;
-            if (lock_timer_ms >= 500) { // LOCK_DELAY_MS
-                lock_piece();
-                return;
-            }
-        }
+// One step covers any dt: it works out how many rows came due, moves the
+// piece at most ghost_drop rows in one go and counts the time spent resting
+// on the stack towards the lock delay. No per-row work, even at 20G.
+// Returns the part of dt_ms left over after the piece locked, 0 otherwise.
+static long gravity_step(long dt_ms) {
+    if (ghost_drop < 0) return 0;                   // no active piece
+
+    long acc = fall_acc + dt_ms * fall_rows;
+    long due = acc / fall_interval_ms;
+    long rest_ms = dt_ms;
+
+    if (due < ghost_drop) {
+        fall_acc = acc % fall_interval_ms;
+        if (due) { move_piece_down_by((int)due); lock_timer_ms = 0; } // still airborne afterwards
+        return 0;
     }
+    if (ghost_drop > 0) {
+        // the landing row came due once fall_acc + t * fall_rows reached ghost_drop * interval
+        long t = ((long)ghost_drop * fall_interval_ms - fall_acc + fall_rows - 1) / fall_rows;
+        rest_ms = dt_ms - t;
+        move_piece_down_by(ghost_drop);
+        lock_timer_ms = 0;
+    }
+    fall_acc = acc % fall_interval_ms;              // rows owed while resting are dropped
+    lock_timer_ms += rest_ms;
+    if (lock_timer_ms < lock_delay_ms) return 0;
+    long left = lock_timer_ms - lock_delay_ms;
+    lock_piece();
+    return left;
 }
 
 // ======================= Menu / Options helpers ==================
@@ -373,12 +552,15 @@ static void draw_menu(void) {
     printf("[p] Play\n");
     printf("[o] Options\n");
     printf("[q] Quit\n");
-    printf("\nControls in-game: A/D move, W rotate, Space = soft drop (if enabled), ESC = menu\n\n");
+    printf("\nControls in-game: A/D move, W rotate, S hard drop, Space = soft drop (if enabled), ESC = menu\n\n");
 }
-static void draw_options(int start_level, int soft_drop) {
+static void draw_options(int start_level, int soft_drop, int bag, int high_gravity, int curve) {
     printf("==== O P T I O N S ====\n");
     printf("Starting Level: %d  (←/→ to change)\n", start_level);
     printf("Soft Drop: %s      (s to toggle)\n", soft_drop ? "ON" : "OFF");
+    printf("Randomizer: %s (r to toggle)\n", bag ? "BAG    " : "UNIFORM");
+    printf("Gravity: %s       (g to toggle)\n", high_gravity ? "20G  " : "LEVEL");
+    printf("Speed curve: %-7s (c to cycle)\n", SPEED_CURVE_NAMES[curve]);
     printf("\n[b] Back\n\n");
 }
 
@@ -389,100 +571,187 @@ static void reset_game_with_options(void) {
     lines_total = 0;
     level = opt_start_level;
 
-    double ms = 1000.0 * pow(0.90, (double)level);
-    if (ms < 80.0) ms = 80.0;
-    fall_interval_ms = (int)ms;
+    next_level_lines = speed_next_level_lines(opt_speed_curve, opt_start_level, level);
+    load_speed();
 
-    fall_timer_ms = 0;
+    fall_acc = 0;
     lock_timer_ms = 0;
+    for (int c = 0; c < W; ++c) col_height[c] = 0;
+    ghost_drop = -1;
     new_block = 1;
     x = 2;
+    game_start_ms = now_ms();
+    pieces_locked = 0;
+    game_id = games_started++;
+    pieces_init(&pieces, rng_split(&seed_rng, game_id), 6,
+                opt_bag_randomizer ? PIECES_BAG : PIECES_UNIFORM);
+}
+
+// ============================= EVENT LOOP ========================
+// The loop sleeps until a key arrives or the display timer ticks. Keys are
+// handled as soon as they arrive, game logic advances over the elapsed time
+// in one analytic gravity step (two when a piece locks and the next spawns),
+// and the screen is redrawn at most once per tick.
+#define DISPLAY_TICK_MS 16
+
+#ifdef __linux__
+static int ep_fd = -1, tick_fd = -1;
+
+static void loop_init(void) {
+    ep_fd = epoll_create1(0);
+    tick_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    if (ep_fd < 0 || tick_fd < 0) { perror("epoll/timerfd"); exit(1); }
+
+    struct itimerspec its = {
+        .it_interval = { 0, DISPLAY_TICK_MS * 1000000L },
+        .it_value    = { 0, DISPLAY_TICK_MS * 1000000L },
+    };
+    timerfd_settime(tick_fd, 0, &its, NULL);
+
+    struct epoll_event ev = { .events = EPOLLIN };
+    ev.data.fd = STDIN_FILENO;
+    epoll_ctl(ep_fd, EPOLL_CTL_ADD, STDIN_FILENO, &ev);
+    ev.data.fd = tick_fd;
+    epoll_ctl(ep_fd, EPOLL_CTL_ADD, tick_fd, &ev);
+}
+
+// block until input or a display tick; returns 1 if the display ticked
+static int loop_wait(void) {
+    struct epoll_event ev[2];
+    int n = epoll_wait(ep_fd, ev, 2, -1);
+    int tick = 0;
+    for (int i = 0; i < n; ++i) {
+        if (ev[i].data.fd == tick_fd) {
+            uint64_t expirations;
+            if (read(tick_fd, &expirations, sizeof expirations) > 0) tick = 1;
+        } else if (ev[i].events & (EPOLLHUP | EPOLLERR)) {
+            epoll_ctl(ep_fd, EPOLL_CTL_DEL, STDIN_FILENO, NULL); // input closed
+        }
+    }
+    return tick;
+}
+#else
+// portable fallback (macOS): poll() on stdin with the time to the next tick
+static long next_tick_ms;
+static int stdin_open = 1;
+
+static void loop_init(void) { next_tick_ms = now_ms() + DISPLAY_TICK_MS; }
+
+static int loop_wait(void) {
+    long wait = next_tick_ms - now_ms();
+    if (wait > 0) {
+        struct pollfd pfd = { .fd = stdin_open ? STDIN_FILENO : -1, .events = POLLIN };
+        if (poll(&pfd, 1, (int)wait) > 0 && (pfd.revents & (POLLHUP | POLLERR)))
+            stdin_open = 0;
+        if (now_ms() < next_tick_ms) return 0;
+    }
+    next_tick_ms += DISPLAY_TICK_MS;
+    if (next_tick_ms <= now_ms()) next_tick_ms = now_ms() + DISPLAY_TICK_MS; // skip missed ticks
+    return 1;
+}
+#endif
+
+static void render(GameState state) {
+    printf("\x1b[2J\x1b[H"); // Clear screen (ANSI)
+    switch (state) {
+        case ST_MENU:    draw_menu(); break;
+        case ST_OPTIONS: draw_options(opt_start_level, opt_soft_drop_enabled, opt_bag_randomizer, opt_20g,
+                                      opt_speed_curve); break;
+        case ST_PLAYING:
+            print_pixels();
+            printf("Level: %d  Fall: %d row/%d ms  SoftDrop:%s  Next: %s\n\n",
+                   level, fall_rows, fall_interval_ms, opt_soft_drop_enabled ? "ON" : "OFF",
+                   SHAPE_NAMES[pieces_peek(&pieces, 0)]);
+            break;
+        default: break;
+    }
+    fflush(stdout);
 }
 
 // ================================ MAIN ===========================
 int main(void) {
     unsigned int s = get_seed();
-    srand(s ? s : 1);
+    rng_init(&seed_rng, s, 0);
     flush_stdin_line();
 
+    const char *ev_path = getenv("TETRIS_EVENTS");
+    if (ev_path) {
+        if (ev_log_start(ev_path, 100) == 0) { ev_ring = ev_attach(); atexit(events_stop); }
+        else perror(ev_path);
+    }
+
     term_raw_enable();
     atexit(term_raw_disable);
 
     GameState state = ST_MENU;
     long prev = now_ms();
+    long logic_acc_ms = 0;
+    int dirty = 1;       // menu/options only redraw after a change
+
+    loop_init();
 
     while (state != ST_EXIT) {
+        int tick = loop_wait();
+
         long t = now_ms();
-        int dt = (int)(t - prev);
+        long dt = t - prev;
         if (dt < 0) dt = 0;
         prev = t;
 
-        // Clear screen (ANSI)
-        printf("\x1b[2J\x1b[H");
-
-        switch (state) {
-            case ST_MENU: {
-                draw_menu();
-                for (;;) {
-                    int key = poll_key();
-                    if (!key) break;
+        // input: everything that is pending, right away
+        KeyEvent keys[64];
+        int nkeys = input_poll(keys, 64);
+        for (int k = 0; k < nkeys && state != ST_EXIT; ++k) {
+            int key = keys[k].key;
+            switch (state) {
+                case ST_MENU:
                     if (key == 'p' || key == 'P') {
                         reset_game_with_options();
+                        logic_acc_ms = 0;
                         state = ST_PLAYING;
-                        break;
                     } else if (key == 'o' || key == 'O') {
                         state = ST_OPTIONS;
-                        break;
                     } else if (key == 'q' || key == 'Q' || key == KEY_ESC) {
                         state = ST_EXIT;
-                        break;
                     }
-                }
-                struct timespec ts = { .tv_sec = 0, .tv_nsec = 20*1000*1000 };
-                nanosleep(&ts, NULL);
-            } break;
-
-            case ST_OPTIONS: {
-                draw_options(opt_start_level, opt_soft_drop_enabled);
-                for (;;) {
-                    int key = poll_key();
-                    if (!key) break;
+                    break;
+                case ST_OPTIONS:
                     if (key == KEY_ARROW_LEFT && opt_start_level > 0)  opt_start_level--;
                     if (key == KEY_ARROW_RIGHT && opt_start_level < 20) opt_start_level++;
                     if (key == 's' || key == 'S') opt_soft_drop_enabled ^= 1;
-                    if (key == 'b' || key == 'B' || key == KEY_ESC) { state = ST_MENU; break; }
-                }
-                struct timespec ts = { .tv_sec = 0, .tv_nsec = 20*1000*1000 };
-                nanosleep(&ts, NULL);
-            } break;
-
-            case ST_PLAYING: {
-                // input
-                for (;;) {
-                    int key = poll_key();
-                    if (!key) break;
+                    if (key == 'r' || key == 'R') opt_bag_randomizer ^= 1;
+                    if (key == 'g' || key == 'G') opt_20g ^= 1;
+                    if (key == 'c' || key == 'C') opt_speed_curve = (opt_speed_curve + 1) % SPEED_CURVES;
+                    if (key == 'b' || key == 'B' || key == KEY_ESC) state = ST_MENU;
+                    break;
+                case ST_PLAYING:
                     if (key == KEY_LEFT_MOVE)       move_piece_horiz(-1);
                     else if (key == KEY_RIGHT_MOVE) move_piece_horiz(+1);
                     else if (key == KEY_ROTATE)     rotate_active_block(+1);
                     else if (key == KEY_SPACE && opt_soft_drop_enabled && can_piece_fall())
                         move_piece_down();
-                    else if (key == KEY_ESC) { state = ST_MENU; break; }
-                }
-
-                if (state == ST_PLAYING) {
-                    gravity_step(dt);
-                    if (!has_active_piece() && new_block) spawn_random_block();
-
-                    print_pixels();
-                    printf("Level: %d  Fall: %d ms  SoftDrop:%s\n\n",
-                           level, fall_interval_ms, opt_soft_drop_enabled ? "ON" : "OFF");
+                    else if (key == 's' || key == 'S')  hard_drop();
+                    else if (key == KEY_ESC) state = ST_MENU;
+                    break;
+                default: break;
+            }
+            dirty = 1;
+        }
 
-                    struct timespec ts = { .tv_sec = 0, .tv_nsec = 16*1000*1000 };
-                    nanosleep(&ts, NULL);
-                }
-            } break;
+        // logic: gravity_step gives the same result however dt is split up,
+        // so it does not matter how often we wake up or render
+        if (state == ST_PLAYING) {
+            logic_acc_ms += dt;
+            do {
+                logic_acc_ms = gravity_step(logic_acc_ms);
+                if (!has_active_piece() && new_block) spawn_random_block();
+            } while (logic_acc_ms > 0);
+        }
 
-            default: state = ST_EXIT; break;
+        // render: at most once per display tick
+        if (tick && (dirty || state == ST_PLAYING)) {
+            render(state);
+            dirty = 0;
         }
     }
     return 0;
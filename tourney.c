@@ -0,0 +1,268 @@
+// tourney.c — bot configurations played on the same seeds, with paired statistics
+// build: gcc -O2 -std=c11 -pthread tourney.c engine.c bot.c -o tourney -lm
+// run:   ./tourney -n 10000 -t 8 -c greedy=-0.51,0.76,-0.36,-0.18 -c look2=-0.51,0.76,-0.36,-0.18/2
+//
+// Every configuration (weights with an optional wells term, and /depth for
+// the lookahead) plays one solo game per seed, and seed k is always Philox
+// stream k of -s, so all configurations see exactly the same pieces and
+// spawn columns. Threads take blocks of seeds from a shared counter and
+// play each seed for every configuration; results land in
+// per-(configuration, seed) slots and are summed in seed order afterwards,
+// so the report, down to the results hash, does not depend on the thread
+// count or scheduling. Only the timing (pieces per CPU second) varies
+// between runs.
+//
+// Per configuration: mean score with a 95% interval, score percentiles,
+// lines, survival (game time, capped by -T) and the share of games that
+// topped out. Per pair: the mean score difference seed by seed with its
+// 95% interval and t statistic, which is far tighter than comparing two
+// means because both games of a seed had the same luck, and a sign test
+// over the seeds one side won.
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "engine.h"
+#include "bot.h"
+
+// ============================= TIMING ============================
+static long now_ms(void) {
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)(ts.tv_sec*1000LL + ts.tv_nsec/1000000LL);
+}
+static long thread_cpu_ns(void) {
+    struct timespec ts; clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (long)(ts.tv_sec*1000000000LL + ts.tv_nsec);
+}
+
+// ============================= OPTIONS ===========================
+#define MAX_CONFIGS 16
+
+typedef struct {
+    char name[32];
+    BotWeights w;
+    int depth;
+} Config;
+
+static Config configs[MAX_CONFIGS];
+static int n_configs;
+static long opt_seeds = 1000;
+static int opt_threads = 2;
+static Rules opt_rules = RULES_10X20;
+static int opt_level = 0;
+static int opt_bot_ms = 50;          // game ms between bot actions
+static long opt_limit_ms = 600000;   // game time before a game is cut off
+static uint64_t opt_seed = 1;
+
+// ============================= GAMES =============================
+typedef struct {
+    int32_t score, lines;
+    int32_t pieces, time_ms;
+    uint8_t over;                    // topped out, rather than cut off
+} Result;
+
+static Result *results;              // [config * opt_seeds + seed]
+static long *cpu_ns;                 // [thread * MAX_CONFIGS + config]
+static atomic_long next_seed;
+
+static void play(const Config *c, long seed, Result *r) {
+    Rng rng;
+    rng_init(&rng, opt_seed, (uint64_t)seed);
+    Game g;
+    game_init(&g, opt_rules, rng, opt_level);
+    Bot b;
+    bot_init(&b, &c->w);
+    b.depth = c->depth;
+    while (!g.over && g.time_ms < opt_limit_ms) {
+        game_apply(&g, bot_next_action(&b, &g));
+        game_tick(&g, opt_bot_ms);
+    }
+    r->score = g.score;
+    r->lines = g.lines_total;
+    r->pieces = (int32_t)g.pieces;
+    r->time_ms = (int32_t)g.time_ms;
+    r->over = (uint8_t)g.over;
+}
+
+static void *play_thread(void *arg) {
+    long *cpu = arg;
+    for (;;) {
+        long first = atomic_fetch_add(&next_seed, 16);
+        if (first >= opt_seeds) return NULL;
+        long last = first + 16 < opt_seeds ? first + 16 : opt_seeds;
+        for (long s = first; s < last; ++s)
+            for (int c = 0; c < n_configs; ++c) {
+                long t0 = thread_cpu_ns();
+                play(&configs[c], s, &results[c * opt_seeds + s]);
+                cpu[c] += thread_cpu_ns() - t0;
+            }
+    }
+}
+
+// ============================= STATISTICS ========================
+static int cmp_int(const void *a, const void *b) {
+    int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// sorted v[0..n), nearest rank
+static int32_t percentile(const int32_t *v, long n, double q) {
+    long i = (long)ceil(q * (double)n) - 1;
+    return v[i < 0 ? 0 : i >= n ? n - 1 : i];
+}
+
+// mean and sample standard deviation, summed in index order
+static void mean_sd(const double *v, long n, double *mean, double *sd) {
+    double s = 0, ss = 0;
+    for (long i = 0; i < n; ++i) s += v[i];
+    *mean = s / (double)n;
+    for (long i = 0; i < n; ++i) ss += (v[i] - *mean) * (v[i] - *mean);
+    *sd = n > 1 ? sqrt(ss / (double)(n - 1)) : 0.0;
+}
+
+static void report_config(int c, double *tmp, int32_t *sorted, double cpu_s) {
+    const Result *r = &results[c * opt_seeds];
+    long n = opt_seeds, pieces = 0, overs = 0;
+    double lines = 0, secs = 0, mean, sd;
+    for (long s = 0; s < n; ++s) {
+        tmp[s] = r[s].score;
+        sorted[s] = r[s].score;
+        lines += r[s].lines;
+        secs += r[s].time_ms / 1000.0;
+        pieces += r[s].pieces;
+        overs += r[s].over;
+    }
+    mean_sd(tmp, n, &mean, &sd);
+    qsort(sorted, (size_t)n, sizeof *sorted, cmp_int);
+    const Config *k = &configs[c];
+    printf("%-12s %.3f,%.3f,%.3f,%.3f,%.3f /%d\n", k->name, k->w.height, k->w.lines, k->w.holes, k->w.bump,
+           k->w.wells, k->depth);
+    printf("  score %9.1f +- %-7.1f  p10 %d  p50 %d  p90 %d  p99 %d  max %d\n",
+           mean, 1.96 * sd / sqrt((double)n),
+           percentile(sorted, n, 0.10), percentile(sorted, n, 0.50), percentile(sorted, n, 0.90),
+           percentile(sorted, n, 0.99), sorted[n - 1]);
+    printf("  lines %8.1f  survival %6.1f s  topped out %5.1f%%  %7.1f pieces/game  %8.0f pieces/s\n",
+           lines / n, secs / n, 100.0 * overs / n, (double)pieces / n, cpu_s > 0 ? pieces / cpu_s : 0.0);
+}
+
+// a - b seed by seed
+static void report_pair(int a, int b, double *diff) {
+    const Result *ra = &results[a * opt_seeds], *rb = &results[b * opt_seeds];
+    long n = opt_seeds, wins = 0, losses = 0;
+    double mean, sd, surv = 0;
+    for (long s = 0; s < n; ++s) {
+        diff[s] = (double)ra[s].score - rb[s].score;
+        wins += ra[s].score > rb[s].score;
+        losses += ra[s].score < rb[s].score;
+        surv += (ra[s].time_ms - rb[s].time_ms) / 1000.0;
+    }
+    mean_sd(diff, n, &mean, &sd);
+    double se = sd / sqrt((double)n), t = se > 0 ? mean / se : 0.0;
+    long decided = wins + losses;
+    double z = decided ? (wins - decided / 2.0) / sqrt(decided / 4.0) : 0.0;  // sign test, normal approx
+    printf("%-12s - %-12s %+9.1f [%+9.1f, %+9.1f]  t %+7.2f  %s  seeds won %ld lost %ld tied %ld  sign z %+6.2f"
+           "  survival %+6.1f s\n",
+           configs[a].name, configs[b].name, mean, mean - 1.96 * se, mean + 1.96 * se, t,
+           fabs(t) > 1.96 ? "*" : " ", wins, losses, n - decided, z, surv / n);
+}
+
+// FNV-1a over every result in order: equal hashes, equal tournaments
+static uint64_t results_hash(void) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (long i = 0; i < n_configs * opt_seeds; ++i) {
+        const Result *r = &results[i];
+        uint64_t v[3] = { (uint64_t)(uint32_t)r->score << 32 | (uint32_t)r->lines,
+                          (uint64_t)(uint32_t)r->pieces << 32 | (uint32_t)r->time_ms, r->over };
+        for (int k = 0; k < 3; ++k) h = (h ^ v[k]) * 0x100000001B3ull;
+    }
+    return h;
+}
+
+// ================================ MAIN ===========================
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s -c [name=]h,l,holes,bump[,wells][/depth] [-c ...] [-n seeds] [-t threads]"
+                    " [-r 8x8|10x20] [-l level] [-b bot_ms] [-T limit_s] [-s seed]\n", argv0);
+    exit(1);
+}
+
+static void parse_config(const char *s, const char *argv0) {
+    if (n_configs == MAX_CONFIGS) { fprintf(stderr, "at most %d configurations\n", MAX_CONFIGS); exit(1); }
+    Config *c = &configs[n_configs];
+    const char *eq = strchr(s, '=');
+    if (eq) {
+        snprintf(c->name, sizeof c->name, "%.*s", (int)(eq - s), s);
+        s = eq + 1;
+    } else {
+        snprintf(c->name, sizeof c->name, "bot%d", n_configs);
+    }
+    c->w = BOT_DEFAULT_WEIGHTS;
+    c->depth = 1;
+    int at = 0;
+    if (sscanf(s, "%lf,%lf,%lf,%lf%n", &c->w.height, &c->w.lines, &c->w.holes, &c->w.bump, &at) != 4) usage(argv0);
+    s += at;
+    if (*s == ',' && sscanf(s + 1, "%lf%n", &c->w.wells, &at) == 1) s += 1 + at;
+    if (*s == '/' && sscanf(s + 1, "%d%n", &c->depth, &at) == 1) s += 1 + at;
+    if (*s || c->depth < 1 || c->depth > BOT_DEPTH_MAX) usage(argv0);
+    n_configs++;
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "c:n:t:r:l:b:T:s:")) != -1) {
+        switch (opt) {
+            case 'c': parse_config(optarg, argv[0]); break;
+            case 'n': opt_seeds = atol(optarg); break;
+            case 't': opt_threads = atoi(optarg); break;
+            case 'r': opt_rules = strcmp(optarg, "8x8") == 0 ? RULES_8X8 : RULES_10X20; break;
+            case 'l': opt_level = atoi(optarg); break;
+            case 'b': opt_bot_ms = atoi(optarg); break;
+            case 'T': opt_limit_ms = atol(optarg) * 1000L; break;
+            case 's': opt_seed = strtoull(optarg, NULL, 10); break;
+            default: usage(argv[0]);
+        }
+    }
+    if (optind != argc || opt_seeds < 1 || opt_threads < 1 || opt_bot_ms < 1 || opt_limit_ms < 1) usage(argv[0]);
+    if (!n_configs) {
+        configs[0] = (Config){ "default", BOT_DEFAULT_WEIGHTS, 1 };
+        n_configs = 1;
+    }
+
+    results = calloc((size_t)(n_configs * opt_seeds), sizeof *results);
+    cpu_ns = calloc((size_t)opt_threads * MAX_CONFIGS, sizeof *cpu_ns);
+    pthread_t *tids = calloc((size_t)opt_threads, sizeof *tids);
+    double *tmp = malloc((size_t)opt_seeds * sizeof *tmp);
+    int32_t *sorted = malloc((size_t)opt_seeds * sizeof *sorted);
+    if (!results || !cpu_ns || !tids || !tmp || !sorted) { perror("calloc"); return 1; }
+
+    long t0 = now_ms();
+    for (int i = 0; i < opt_threads; ++i) pthread_create(&tids[i], NULL, play_thread, &cpu_ns[i * MAX_CONFIGS]);
+    for (int i = 0; i < opt_threads; ++i) pthread_join(tids[i], NULL);
+    double secs = (now_ms() - t0) / 1000.0;
+    if (secs <= 0) secs = 0.001;
+
+    printf("%ld seeds from %llu, %s level %d, a move every %d ms, cut off at %ld s\n\n",
+           opt_seeds, (unsigned long long)opt_seed, opt_rules == RULES_8X8 ? "8x8" : "10x20", opt_level,
+           opt_bot_ms, opt_limit_ms / 1000);
+    long games_pieces = 0;
+    for (int c = 0; c < n_configs; ++c) {
+        long ns = 0;
+        for (int i = 0; i < opt_threads; ++i) ns += cpu_ns[i * MAX_CONFIGS + c];
+        report_config(c, tmp, sorted, ns / 1e9);
+        for (long s = 0; s < opt_seeds; ++s) games_pieces += results[c * opt_seeds + s].pieces;
+    }
+    if (n_configs > 1) {
+        printf("\npaired score differences (95%% interval, * where |t| > 1.96)\n");
+        for (int a = 0; a < n_configs; ++a)
+            for (int b = a + 1; b < n_configs; ++b) report_pair(a, b, tmp);
+    }
+    printf("\nresults hash %016llx\n", (unsigned long long)results_hash());
+    printf("%ld games in %.2f s wall, %.0f games/s, %.0f pieces/s on %d threads\n",
+           n_configs * opt_seeds, secs, n_configs * opt_seeds / secs, games_pieces / secs, opt_threads);
+    free(results); free(cpu_ns); free(tids); free(tmp); free(sorted);
+    return 0;
+}
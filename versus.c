@@ -0,0 +1,167 @@
+// versus.c — bot-versus-bot matches with garbage, run in bulk
+// build: gcc -O2 -std=c11 -pthread versus.c engine.c bot.c -o versus -lm
+// run:   ./versus -m 20000 -t 4 -A -0.51,0.76,-0.36,-0.18 -B -0.6,0.5,-0.4,-0.2
+//
+// Two greedy bots with their own weights play the versus rules of the
+// engine: both boards get the same pieces, every clear of two or more lines
+// sends garbage to the other side, and the first to top out loses. Matches
+// that reach the time limit, or where both top out in the same step, are
+// draws. Match k always uses Philox stream k of the seed, so the threads
+// can take matches in any order and the totals stay reproducible.
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "engine.h"
+#include "bot.h"
+
+// ============================= TIMING ============================
+static long now_ms(void) {
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)(ts.tv_sec*1000LL + ts.tv_nsec/1000000LL);
+}
+
+// ============================= OPTIONS ===========================
+static long opt_matches = 2000;
+static int opt_threads = 2;
+static Rules opt_rules = RULES_10X20;
+static int opt_level = 0;
+static int opt_bot_ms = 50;          // game ms between bot actions
+static long opt_limit_ms = 600000;   // game time before a draw
+static uint64_t opt_seed = 1;
+static BotWeights opt_w[2];
+
+// ============================= MATCHES ===========================
+typedef struct {
+    long wins[2], draws, pieces, garbage, game_ms;
+} Tally;
+
+static atomic_long next_match;
+
+static void play_match(long id, Tally *t) {
+    Rng r;
+    rng_init(&r, opt_seed, (uint64_t)id);
+    Game g[2];
+    Bot b[2];
+    for (int p = 0; p < 2; ++p) {
+        game_init(&g[p], opt_rules, r, opt_level);   // same stream: same pieces, same holes
+        g[p].versus = 1;
+        bot_init(&b[p], &opt_w[p]);
+    }
+    long ms = 0;
+    while (ms < opt_limit_ms && !g[0].over && !g[1].over) {
+        for (int p = 0; p < 2; ++p) {
+            game_apply(&g[p], bot_next_action(&b[p], &g[p]));
+            game_tick(&g[p], opt_bot_ms);
+        }
+        for (int p = 0; p < 2; ++p) {                // both moved, then the attacks cross
+            int n = game_take_attack(&g[p]);
+            game_receive_garbage(&g[1 - p], n);
+            t->garbage += n;
+        }
+        ms += opt_bot_ms;
+    }
+    if (g[0].over != g[1].over) t->wins[g[0].over ? 1 : 0]++;
+    else t->draws++;
+    t->pieces += g[0].pieces + g[1].pieces;
+    t->game_ms += ms;
+}
+
+static void *sim_thread(void *arg) {
+    Tally *t = arg;
+    for (;;) {
+        long first = atomic_fetch_add(&next_match, 64);
+        if (first >= opt_matches) return NULL;
+        long last = first + 64 < opt_matches ? first + 64 : opt_matches;
+        for (long id = first; id < last; ++id) play_match(id, t);
+    }
+}
+
+// ============================= STATISTICS ========================
+// Wilson score interval for a proportion p of n at z standard errors
+static void wilson(double p, double n, double z, double *lo, double *hi) {
+    double d = 1 + z * z / n;
+    double c = (p + z * z / (2 * n)) / d;
+    double h = z * sqrt(p * (1 - p) / n + z * z / (4 * n * n)) / d;
+    *lo = c - h;
+    *hi = c + h;
+}
+
+static double elo(double score) {
+    if (score <= 0) return -INFINITY;
+    if (score >= 1) return INFINITY;
+    return -400.0 * log10(1.0 / score - 1.0);
+}
+
+// ================================ MAIN ===========================
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-m matches] [-t threads] [-r 8x8|10x20] [-l level] [-b bot_ms]"
+                    " [-T limit_s] [-s seed] [-A h,l,holes,bump] [-B h,l,holes,bump]\n", argv0);
+    exit(1);
+}
+
+static void parse_weights(const char *s, BotWeights *w, const char *argv0) {
+    if (sscanf(s, "%lf,%lf,%lf,%lf", &w->height, &w->lines, &w->holes, &w->bump) != 4) usage(argv0);
+}
+
+int main(int argc, char **argv) {
+    opt_w[0] = opt_w[1] = BOT_DEFAULT_WEIGHTS;
+    int opt;
+    while ((opt = getopt(argc, argv, "m:t:r:l:b:T:s:A:B:")) != -1) {
+        switch (opt) {
+            case 'm': opt_matches = atol(optarg); break;
+            case 't': opt_threads = atoi(optarg); break;
+            case 'r': opt_rules = strcmp(optarg, "8x8") == 0 ? RULES_8X8 : RULES_10X20; break;
+            case 'l': opt_level = atoi(optarg); break;
+            case 'b': opt_bot_ms = atoi(optarg); break;
+            case 'T': opt_limit_ms = atol(optarg) * 1000L; break;
+            case 's': opt_seed = strtoull(optarg, NULL, 10); break;
+            case 'A': parse_weights(optarg, &opt_w[0], argv[0]); break;
+            case 'B': parse_weights(optarg, &opt_w[1], argv[0]); break;
+            default: usage(argv[0]);
+        }
+    }
+    if (opt_matches < 1 || opt_threads < 1 || opt_bot_ms < 1 || opt_limit_ms < 1) usage(argv[0]);
+
+    Tally *tallies = calloc((size_t)opt_threads, sizeof *tallies);
+    pthread_t *tids = calloc((size_t)opt_threads, sizeof *tids);
+    if (!tallies || !tids) { perror("calloc"); return 1; }
+    long t0 = now_ms();
+    for (int i = 0; i < opt_threads; ++i) pthread_create(&tids[i], NULL, sim_thread, &tallies[i]);
+    Tally sum = { { 0, 0 }, 0, 0, 0, 0 };
+    for (int i = 0; i < opt_threads; ++i) {
+        pthread_join(tids[i], NULL);
+        sum.wins[0] += tallies[i].wins[0]; sum.wins[1] += tallies[i].wins[1];
+        sum.draws += tallies[i].draws; sum.pieces += tallies[i].pieces;
+        sum.garbage += tallies[i].garbage; sum.game_ms += tallies[i].game_ms;
+    }
+    double secs = (now_ms() - t0) / 1000.0, n = (double)opt_matches;
+    if (secs <= 0) secs = 0.001;
+
+    // A's score counts a draw as half a win
+    double score = (sum.wins[0] + 0.5 * sum.draws) / n, lo, hi;
+    wilson(score, n, 1.96, &lo, &hi);
+    printf("A %.3f,%.3f,%.3f,%.3f  vs  B %.3f,%.3f,%.3f,%.3f\n",
+           opt_w[0].height, opt_w[0].lines, opt_w[0].holes, opt_w[0].bump,
+           opt_w[1].height, opt_w[1].lines, opt_w[1].holes, opt_w[1].bump);
+    printf("%ld matches: A wins %ld  B wins %ld  draws %ld\n",
+           opt_matches, sum.wins[0], sum.wins[1], sum.draws);
+    printf("A score %.4f  95%% CI [%.4f, %.4f]  Elo %+.0f [%+.0f, %+.0f]\n",
+           score, lo, hi, elo(score), elo(lo), elo(hi));
+    long decisive = sum.wins[0] + sum.wins[1];
+    if (decisive) {
+        wilson((double)sum.wins[0] / decisive, (double)decisive, 1.96, &lo, &hi);
+        printf("A wins %.4f of decisive matches  95%% CI [%.4f, %.4f]\n",
+               (double)sum.wins[0] / decisive, lo, hi);
+    }
+    printf("avg match %.1f s game time, %.0f pieces, %.1f garbage lines\n",
+           sum.game_ms / 1000.0 / n, sum.pieces / n, sum.garbage / n);
+    printf("%.2f s wall, %.0f matches/s, %.0f pieces/s on %d threads\n",
+           secs, n / secs, sum.pieces / secs, opt_threads);
+    return 0;
+}